@@ -1,7 +1,13 @@
 #pragma once
 
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
 
+#include <array>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
 namespace eosio {
    struct [[eosio::table, eosio::contract("rem.auth")]] attribute_info {
       name    attribute_name;
@@ -9,10 +15,16 @@ namespace eosio {
       int32_t ptype;
       bool valid = true;
 
-      uint64_t next_id = 0;
+      uint64_t next_id = 0; // ids of unset attributes are not reused
+      binary_extension<uint64_t> count; // number of set attributes, ids were dense before it was added
+      binary_extension<bool> has_directory; // set attributes are listed in the attrdir table of the receiver
+      binary_extension<uint64_t> listed_id; // attributes with lower ids are listed, the ones set before the directory was enabled are listed by listattrs
 
       uint64_t primary_key() const { return attribute_name.value; }
       bool is_valid() const { return valid; }
+      uint64_t get_count() const { return count.has_value() ? count.value() : next_id; }
+      bool is_listed() const { return has_directory.value_or( false ); }
+      bool is_directory_complete() const { return is_listed() && listed_id.value_or( 0 ) >= next_id; }
    };
    typedef eosio::multi_index< "attrinfo"_n, attribute_info > attribute_info_table;
 
@@ -45,15 +57,59 @@ namespace eosio {
                                indexed_by<"reciss"_n, const_mem_fun<attribute_data, uint128_t, &attribute_data::by_receiver_issuer>  >
                                > attributes_table;
 
+   /**
+    * Attributes set to one receiver, the table is scoped by the receiver. Only attributes with the directory
+    * enabled by setdirectory are listed, the entry is billed to the issuer of the attribute.
+    */
+   struct [[eosio::table, eosio::contract("rem.auth")]] attribute_entry {
+      uint64_t     id;
+      name         attribute_name;
+      name         issuer;
+      uint64_t     attribute_id;
+      bool         pending = false; // the value is waiting for confirmation by the receiver
+
+      uint64_t primary_key() const { return id; }
+      uint128_t by_attribute_issuer() const { return combine_attribute_issuer(attribute_name, issuer); }
+
+      static uint128_t combine_attribute_issuer(name attribute_name, name issuer)
+      {
+         uint128_t result = attribute_name.value;
+         result <<= 64;
+         result |= issuer.value;
+         return result;
+      }
+   };
+   typedef eosio::multi_index< "attrdir"_n, attribute_entry,
+                               indexed_by<"attriss"_n, const_mem_fun<attribute_entry, uint128_t, &attribute_entry::by_attribute_issuer>  >
+                               > attribute_directory_table;
+
    class [[eosio::contract("rem.auth")]] attribute : public contract {
    public:
       using contract::contract;
 
+      enum class data_type : int32_t { Boolean = 0, Int, LargeInt, Double, ChainAccount, UTFString, DateTimeUTC, CID, OID, Binary, Set, MaxVal };
+
       static bool has_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name );
 
       template< class T >
       static T get_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name );
 
+      // returns std::nullopt if the attribute doesn't exist, is marked for deletion, isn't set by issuer to receiver
+      // or its value is not confirmed by receiver yet
+      template< class T >
+      static std::optional<T> find_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name );
+
+      // typed value of an attribute of type `Type`, only for types whose value is copied out of the row
+      template< data_type Type >
+      static auto find_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name );
+
+      // calls `visitor` with a view of the value of an attribute of type `Type`, the view is valid only during the call,
+      // returns false if the attribute doesn't exist, is marked for deletion, isn't set by issuer to receiver
+      // or its value is not confirmed by receiver yet
+      template< data_type Type, class Visitor >
+      static bool visit_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name,
+                                   Visitor&& visitor );
+
       [[eosio::action]]
       void confirm( const name& owner, const name& issuer, const name& attribute_name );
 
@@ -72,22 +128,129 @@ namespace eosio {
       [[eosio::action]]
       void unsetattr( const name& issuer, const name& receiver, const name& attribute_name );
 
+      [[eosio::action]]
+      void setattrs( const name& issuer, const name& attribute_name, const std::vector<std::pair<name, std::vector<char>>>& values );
+
+      [[eosio::action]]
+      void unsetattrs( const name& issuer, const name& attribute_name, const std::vector<name>& receivers );
+
+      [[eosio::action]]
+      void setdirectory( const name& attribute_name, bool enabled );
+
+      [[eosio::action]]
+      void listattrs( const name& attribute_name, uint64_t max_rows );
+
       using confirm_action    = eosio::action_wrapper<"confirm"_n,       &attribute::confirm>;
       using create_action     = eosio::action_wrapper<"create"_n,         &attribute::create>;
       using invalidate_action = eosio::action_wrapper<"invalidate"_n, &attribute::invalidate>;
       using remove_action     = eosio::action_wrapper<"remove"_n,         &attribute::remove>;
       using setattr_action    = eosio::action_wrapper<"setattr"_n,       &attribute::setattr>;
       using unsetattr_action  = eosio::action_wrapper<"unsetattr"_n,   &attribute::unsetattr>;
+      using setattrs_action   = eosio::action_wrapper<"setattrs"_n,     &attribute::setattrs>;
+      using unsetattrs_action = eosio::action_wrapper<"unsetattrs"_n, &attribute::unsetattrs>;
+      using setdirectory_action = eosio::action_wrapper<"setdirectory"_n, &attribute::setdirectory>;
+      using listattrs_action  = eosio::action_wrapper<"listattrs"_n,   &attribute::listattrs>;
 
    private:
-      enum class data_type : int32_t { Boolean = 0, Int, LargeInt, Double, ChainAccount, UTFString, DateTimeUTC, CID, OID, Binary, Set, MaxVal };
       enum class privacy_type : int32_t { SelfAssigned = 0, PublicPointer, PublicConfirmedPointer, PrivatePointer, PrivateConfirmedPointer, MaxVal };
 
+      void set_attributes( const name& issuer, const name& attribute_name, const std::vector<std::pair<name, std::vector<char>>>& values );
+      void unset_attributes( const name& issuer, const name& attribute_name, const std::vector<name>& receivers );
+
+      void set_directory_entry( const name& payer, const name& receiver, const name& issuer, const name& attribute_name, uint64_t attribute_id, bool pending );
+      void erase_directory_entry( const name& receiver, const name& issuer, const name& attribute_name );
+
+      template< data_type Type >
+      static void check_value(const std::vector<char>& data);
+
       void check_attribute_data(const std::vector<char>& data, int32_t type) const;
       void check_permission(const name& issuer, const name& receiver, int32_t ptype) const;
       bool need_confirm(int32_t ptype) const;
    };
 
+   /**
+    * Read-only view of the bytes of an attribute value.
+    */
+   struct attribute_bytes {
+      const char* ptr = nullptr;
+      size_t      len = 0;
+
+      const char* data()  const { return ptr; }
+      size_t      size()  const { return len; }
+      const char* begin() const { return ptr; }
+      const char* end()   const { return ptr + len; }
+   };
+
+   /**
+    * Maps an attribute data type to the C++ type of its value.
+    *
+    * @details `is_valid` checks the stored bytes of a value, `read` returns the value, which is a view over
+    * the stored bytes if `is_view` is true.
+    */
+   template< attribute::data_type Type >
+   struct attribute_traits;
+
+   template< class T >
+   struct scalar_attribute_traits {
+      using value_type = T;
+      static constexpr bool is_view = false;
+
+      static bool is_valid( const std::vector<char>& data ) { return data.size() == sizeof(T); }
+      static value_type read( const std::vector<char>& data ) { return unpack< T >( data.data(), data.size() ); }
+   };
+
+   // values prefixed with a one byte length
+   template< class View >
+   struct sized_attribute_traits {
+      using value_type = View;
+      static constexpr bool is_view = true;
+
+      static bool is_valid( const std::vector<char>& data ) { return !data.empty() && data.size() == static_cast<size_t>( data.front() + 1 ); }
+      static value_type read( const std::vector<char>& data ) { return value_type{ data.data() + 1, data.size() - 1 }; }
+   };
+
+   // values without a defined layout
+   struct raw_attribute_traits {
+      using value_type = attribute_bytes;
+      static constexpr bool is_view = true;
+
+      static bool is_valid( const std::vector<char>& ) { return true; }
+      static value_type read( const std::vector<char>& data ) { return value_type{ data.data(), data.size() }; }
+   };
+
+   template<> struct attribute_traits< attribute::data_type::Boolean > : scalar_attribute_traits< bool > {
+      static constexpr const char* error = "invalid Boolean value";
+   };
+   template<> struct attribute_traits< attribute::data_type::Int > : scalar_attribute_traits< int32_t > {
+      static constexpr const char* error = "invalid Int value";
+   };
+   template<> struct attribute_traits< attribute::data_type::LargeInt > : scalar_attribute_traits< int64_t > {
+      static constexpr const char* error = "invalid LargeInt value";
+   };
+   template<> struct attribute_traits< attribute::data_type::Double > : scalar_attribute_traits< double > {
+      static constexpr const char* error = "invalid Double value";
+   };
+   template<> struct attribute_traits< attribute::data_type::DateTimeUTC > : scalar_attribute_traits< int64_t > {
+      static constexpr const char* error = "invalid DateTimeUTC value";
+   };
+   template<> struct attribute_traits< attribute::data_type::UTFString > : sized_attribute_traits< std::string_view > {
+      static constexpr const char* error = "invalid UTFString value";
+   };
+   template<> struct attribute_traits< attribute::data_type::Binary > : sized_attribute_traits< attribute_bytes > {
+      static constexpr const char* error = "invalid Binary value";
+   };
+   template<> struct attribute_traits< attribute::data_type::ChainAccount > {
+      using value_type = const std::array<char, 40>&;
+      static constexpr bool is_view = true;
+      static constexpr const char* error = "invalid ChainAccount value";
+
+      static bool is_valid( const std::vector<char>& data ) { return data.size() == 40; }
+      static value_type read( const std::vector<char>& data ) { return *reinterpret_cast<const std::array<char, 40>*>( data.data() ); }
+   };
+   template<> struct attribute_traits< attribute::data_type::CID > : raw_attribute_traits {};
+   template<> struct attribute_traits< attribute::data_type::OID > : raw_attribute_traits {};
+   template<> struct attribute_traits< attribute::data_type::Set > : raw_attribute_traits {};
+
    inline bool attribute::has_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name )
    {
       attribute_info_table attributes_info{ attr_contract_account, attr_contract_account.value };
@@ -119,8 +282,72 @@ namespace eosio {
       const auto& idx = attributes.get_index<"reciss"_n>();
       const auto& attr = idx.get( attribute_data::combine_receiver_issuer(receiver, issuer), "attribute not set by issuer to receiver" );
 
+      static_assert( std::is_trivially_copyable_v< T >, "get_attribute reads fixed size values only, use visit_attribute" );
       const T value = unpack< T >( attr.attribute.data.data(), sizeof( T ) );
 
       return value;
    }
+
+   template< class T >
+   std::optional<T> attribute::find_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name )
+   {
+      attribute_info_table attributes_info{ attr_contract_account, attr_contract_account.value };
+      const auto it = attributes_info.find( attribute_name.value );
+
+      if ( it == attributes_info.end() || !it->is_valid() ) {
+         return std::nullopt;
+      }
+
+      attributes_table attributes( attr_contract_account, attribute_name.value );
+      const auto idx = attributes.get_index<"reciss"_n>();
+      const auto attr_it = idx.find( attribute_data::combine_receiver_issuer(receiver, issuer) );
+
+      if ( attr_it == idx.end() || attr_it->attribute.data.empty() ) {
+         return std::nullopt;
+      }
+      return unpack< T >( attr_it->attribute.data.data(), attr_it->attribute.data.size() );
+   }
+
+   template< attribute::data_type Type, class Visitor >
+   bool attribute::visit_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name,
+                                    Visitor&& visitor )
+   {
+      using traits = attribute_traits< Type >;
+      static_assert( std::is_invocable_v< Visitor, typename traits::value_type >, "visitor doesn't accept the attribute value type" );
+
+      attribute_info_table attributes_info{ attr_contract_account, attr_contract_account.value };
+      const auto it = attributes_info.find( attribute_name.value );
+
+      if ( it == attributes_info.end() || !it->is_valid() ) {
+         return false;
+      }
+      check( it->type == static_cast<int32_t>( Type ), "attribute type mismatch" );
+
+      attributes_table attributes( attr_contract_account, attribute_name.value );
+      const auto idx = attributes.get_index<"reciss"_n>();
+      const auto attr_it = idx.find( attribute_data::combine_receiver_issuer(receiver, issuer) );
+
+      if ( attr_it == idx.end() || attr_it->attribute.data.empty() ) {
+         return false;
+      }
+      visitor( traits::read( attr_it->attribute.data ) );
+      return true;
+   }
+
+   template< attribute::data_type Type >
+   auto attribute::find_attribute( const name& attr_contract_account, const name& issuer, const name& receiver, const name& attribute_name )
+   {
+      using value_type = typename attribute_traits< Type >::value_type;
+      static_assert( !attribute_traits< Type >::is_view, "the value is a view over the row, use visit_attribute" );
+
+      std::optional< value_type > value;
+      visit_attribute< Type >( attr_contract_account, issuer, receiver, attribute_name, [&]( value_type v ) { value = v; } );
+      return value;
+   }
+
+   template< attribute::data_type Type >
+   void attribute::check_value( const std::vector<char>& data )
+   {
+      check( attribute_traits< Type >::is_valid( data ), attribute_traits< Type >::error );
+   }
 } /// namespace eosio
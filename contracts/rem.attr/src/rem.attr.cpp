@@ -15,6 +15,12 @@ namespace eosio {
          attr.attribute.data.swap(attr.attribute.pending);
          attr.attribute.pending.clear();
       });
+
+      attribute_info_table attributes_info( _self, _self.value );
+      const auto attrinfo_it = attributes_info.find( attribute_name.value );
+      if ( attrinfo_it != attributes_info.end() && attrinfo_it->is_listed() ) {
+         set_directory_entry( owner, owner, issuer, attribute_name, attr_it->id, false );
+      }
    }
 
    void attribute::create( const name& attribute_name, int32_t type, int32_t ptype )
@@ -30,6 +36,7 @@ namespace eosio {
          attr.attribute_name = attribute_name;
          attr.type           = type;
          attr.ptype          = ptype;
+         attr.count.emplace(0);
       });
    }
 
@@ -42,6 +49,7 @@ namespace eosio {
 
       attributes_info.modify(attrinfo, same_payer, [&]( auto& a ) {
          a.valid = false;
+         a.count.emplace(a.get_count()); // the row is written with the extension, keep the count of former rows
       });
    }
 
@@ -59,111 +67,212 @@ namespace eosio {
    }
 
    void attribute::setattr( const name& issuer, const name& receiver, const name& attribute_name, const std::vector<char>& value )
+   {
+      set_attributes( issuer, attribute_name, { { receiver, value } } );
+   }
+
+   void attribute::unsetattr( const name& issuer, const name& receiver, const name& attribute_name )
+   {
+      unset_attributes( issuer, attribute_name, { receiver } );
+   }
+
+   void attribute::setattrs( const name& issuer, const name& attribute_name, const std::vector<std::pair<name, std::vector<char>>>& values )
+   {
+      check( !values.empty(), "empty attributes list" );
+      set_attributes( issuer, attribute_name, values );
+   }
+
+   void attribute::unsetattrs( const name& issuer, const name& attribute_name, const std::vector<name>& receivers )
+   {
+      check( !receivers.empty(), "empty receivers list" );
+      unset_attributes( issuer, attribute_name, receivers );
+   }
+
+   void attribute::set_attributes( const name& issuer, const name& attribute_name, const std::vector<std::pair<name, std::vector<char>>>& values )
    {
       require_auth( issuer );
-      require_recipient( receiver );
 
       attribute_info_table attributes_info( _self, _self.value );
       const auto& attrinfo = attributes_info.get( attribute_name.value, "attribute does not exist" );
-      check(attrinfo.next_id < std::numeric_limits<uint64_t>::max(), "attribute storage is full");
+      check( values.size() <= std::numeric_limits<uint64_t>::max() - attrinfo.next_id, "attribute storage is full" );
       check( attrinfo.is_valid(), "this attribute is beeing deleted" );
-      check_permission(issuer, receiver, attrinfo.ptype);
-      check_attribute_data(value, attrinfo.type);
-
-      const auto id = attrinfo.next_id;
+      const bool is_pending = need_confirm( attrinfo.ptype );
+      const bool is_listed = attrinfo.is_listed();
 
       attributes_table attributes( _self, attribute_name.value );
       auto idx = attributes.get_index<"reciss"_n>();
-      const auto attr_it = idx.find( attribute_data::combine_receiver_issuer(receiver, issuer) );
-      if ( attr_it == idx.end() ) {
-         attributes.emplace( issuer, [&]( auto& attr ) {
-            attr.id = id;
-            attr.issuer = issuer;
-            attr.receiver = receiver;
-            if (need_confirm(attrinfo.ptype)) {
-               attr.attribute.pending = value;
+      uint64_t next_id = attrinfo.next_id;
+      for ( const auto& [receiver, value] : values ) {
+         check_permission( issuer, receiver, attrinfo.ptype );
+         check_attribute_data( value, attrinfo.type );
+         require_recipient( receiver );
+
+         const auto attr_it = idx.find( attribute_data::combine_receiver_issuer(receiver, issuer) );
+         if ( attr_it == idx.end() ) {
+            attributes.emplace( issuer, [&]( auto& attr ) {
+               attr.id = next_id;
+               attr.issuer = issuer;
+               attr.receiver = receiver;
+               if (is_pending) {
+                  attr.attribute.pending = value;
+               }
+               else {
+                  attr.attribute.data = value;
+               }
+            });
+            if ( is_listed ) {
+               set_directory_entry( issuer, receiver, issuer, attribute_name, next_id, is_pending );
             }
-            else {
-               attr.attribute.data = value;
+            ++next_id;
+         } else {
+            idx.modify( attr_it, issuer, [&]( auto& attr ) {
+               if (is_pending) {
+                  attr.attribute.pending = value;
+               }
+               else {
+                  attr.attribute.data = value;
+               }
+            });
+            if ( is_listed ) {
+               set_directory_entry( issuer, receiver, issuer, attribute_name, attr_it->id, is_pending );
             }
-         });
+         }
+      }
+
+      if ( next_id != attrinfo.next_id ) {
          attributes_info.modify(attrinfo, same_payer, [&]( auto& a ) {
-            a.next_id += 1;
-         });
-      } else {
-         idx.modify( attr_it, issuer, [&]( auto& attr ) {
-            attr.issuer = issuer;
-            attr.receiver = receiver;
-            if (need_confirm(attrinfo.ptype)) {
-               attr.attribute.pending = value;
-            }
-            else {
-               attr.attribute.data = value;
-            }
+            a.count.emplace(a.get_count() + (next_id - a.next_id));
+            a.next_id = next_id;
          });
       }
    }
 
-   void attribute::unsetattr( const name& issuer, const name& receiver, const name& attribute_name )
+   void attribute::unset_attributes( const name& issuer, const name& attribute_name, const std::vector<name>& receivers )
    {
       attribute_info_table attributes_info( _self, _self.value );
       const auto& attrinfo = attributes_info.get( attribute_name.value, "attribute does not exist" );
+      const bool is_confirmed_attribute = need_confirm( attrinfo.ptype );
+      const bool is_issuer = has_auth( issuer );
 
-      if (attrinfo.is_valid()) { // when attribute became invalid anyone can unset
-         if (need_confirm(attrinfo.ptype)) {
-            check(has_auth(issuer) || has_auth(receiver), "missing required authority");
-         } else {
-            require_auth(issuer);
+      attributes_table attributes( _self, attribute_name.value );
+      auto idx = attributes.get_index<"reciss"_n>();
+      for ( const auto& receiver : receivers ) {
+         if (attrinfo.is_valid()) { // when attribute became invalid anyone can unset
+            if (is_confirmed_attribute) {
+               check(is_issuer || has_auth(receiver), "missing required authority");
+            } else {
+               require_auth(issuer);
+            }
          }
+         require_recipient( receiver );
+
+         const auto attr_it = idx.require_find( attribute_data::combine_receiver_issuer(receiver, issuer), "attribute hasn`t been set for account" );
+         idx.erase(attr_it);
+         // entries listed before the directory was disabled are removed too
+         erase_directory_entry( receiver, issuer, attribute_name );
       }
-      require_recipient( receiver );
+
+      attributes_info.modify(attrinfo, same_payer, [&]( auto& a ) {
+         a.count.emplace(a.get_count() - receivers.size());
+      });
+   }
+
+   void attribute::setdirectory( const name& attribute_name, bool enabled )
+   {
+      require_auth( _self );
+
+      attribute_info_table attributes_info( _self, _self.value );
+      const auto& attrinfo = attributes_info.get( attribute_name.value, "attribute does not exist" );
+
+      const bool is_enabling = enabled && !attrinfo.is_listed();
+      attributes_info.modify(attrinfo, same_payer, [&]( auto& a ) {
+         a.count.emplace(a.get_count());
+         a.has_directory.emplace(enabled);
+         // attributes set while the directory was disabled are not listed until listattrs reaches them
+         a.listed_id.emplace(is_enabling ? 0 : a.listed_id.value_or( 0 ));
+      });
+   }
+
+   void attribute::listattrs( const name& attribute_name, uint64_t max_rows )
+   {
+      require_auth( _self );
+      check( max_rows > 0, "max_rows must be positive" );
+
+      attribute_info_table attributes_info( _self, _self.value );
+      const auto& attrinfo = attributes_info.get( attribute_name.value, "attribute does not exist" );
+      check( attrinfo.is_listed(), "directory is not enabled for the attribute" );
 
       attributes_table attributes( _self, attribute_name.value );
-      auto idx = attributes.get_index<"reciss"_n>();
-      const auto attr_it = idx.require_find( attribute_data::combine_receiver_issuer(receiver, issuer), "attribute hasn`t been set for account" );
-      const auto erased_id = attr_it->id;
-      idx.erase(attr_it);
-      if (erased_id != attrinfo.next_id - 1) {
-         const auto& attr_to_move = attributes.get(attrinfo.next_id - 1);
-         auto moved_attr = attr_to_move;
-         moved_attr.id = erased_id;
-         attributes.erase(attr_to_move); //erase before emplace to avoid error when ram payer has no free RAM
-         attributes.emplace( attr_to_move.issuer, [&]( auto& attr ) {
-            attr = moved_attr;
-         });
+      auto attr_it = attributes.lower_bound( attrinfo.listed_id.value_or( 0 ) );
+      for ( uint64_t i = 0; attr_it != attributes.end() && i < max_rows; ++attr_it, ++i ) {
+         set_directory_entry( _self, attr_it->receiver, attr_it->issuer, attribute_name, attr_it->id, !attr_it->attribute.pending.empty() );
       }
+
+      const uint64_t listed_id = attr_it == attributes.end() ? attrinfo.next_id : attr_it->id;
       attributes_info.modify(attrinfo, same_payer, [&]( auto& a ) {
-         a.next_id -= 1;
+         a.count.emplace(a.get_count());
+         a.listed_id.emplace(listed_id);
       });
    }
 
+   void attribute::set_directory_entry( const name& payer, const name& receiver, const name& issuer, const name& attribute_name, uint64_t attribute_id, bool pending )
+   {
+      attribute_directory_table directory( _self, receiver.value );
+      auto idx = directory.get_index<"attriss"_n>();
+      const auto entry_it = idx.find( attribute_entry::combine_attribute_issuer(attribute_name, issuer) );
+      if ( entry_it == idx.end() ) {
+         // attributes set before the directory was enabled are added by listattrs or when they are set again
+         directory.emplace( payer, [&]( auto& entry ) {
+            entry.id             = directory.available_primary_key();
+            entry.attribute_name = attribute_name;
+            entry.issuer         = issuer;
+            entry.attribute_id   = attribute_id;
+            entry.pending        = pending;
+         });
+      } else if ( entry_it->pending != pending ) {
+         idx.modify( entry_it, same_payer, [&]( auto& entry ) {
+            entry.pending = pending;
+         });
+      }
+   }
+
+   void attribute::erase_directory_entry( const name& receiver, const name& issuer, const name& attribute_name )
+   {
+      attribute_directory_table directory( _self, receiver.value );
+      auto idx = directory.get_index<"attriss"_n>();
+      const auto entry_it = idx.find( attribute_entry::combine_attribute_issuer(attribute_name, issuer) );
+      if ( entry_it != idx.end() ) {
+         idx.erase( entry_it );
+      }
+   }
+
    void attribute::check_attribute_data(const std::vector<char>& data, int32_t type) const
    {
       check( !data.empty(), "value is empty" );
       switch(static_cast<data_type>( type )) {
          case data_type::Boolean:
-            check( data.size() == 1, "invalid Boolean value" );
+            check_value<data_type::Boolean>( data );
             break;
          case data_type::Int:
-            check( data.size() == sizeof(int32_t), "invalid Int value" );
+            check_value<data_type::Int>( data );
             break;
          case data_type::LargeInt:
-            check( data.size() == sizeof(int64_t), "invalid LargeInt value" );
+            check_value<data_type::LargeInt>( data );
             break;
          case data_type::ChainAccount:
-            check( data.size() == 40, "invalid ChainAccount value" );
+            check_value<data_type::ChainAccount>( data );
             break;
          case data_type::UTFString:
-            check( data.size() == data.front() + 1, "invalid UTFString value" );
+            check_value<data_type::UTFString>( data );
             break;
          case data_type::DateTimeUTC:
-            check( data.size() == sizeof(int64_t), "invalid DateTimeUTC value" );
+            check_value<data_type::DateTimeUTC>( data );
             break;
          case data_type::Binary:
-            check( data.size() == data.front() + 1, "invalid Binary value" );
+            check_value<data_type::Binary>( data );
             break;
          case data_type::Double:
-            check( data.size() == sizeof(double), "invalid Double value" );
+            check_value<data_type::Double>( data );
             break;
          case data_type::CID:
          case data_type::OID:
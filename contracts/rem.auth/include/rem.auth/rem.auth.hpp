@@ -32,6 +32,17 @@ namespace eosio {
       auth(name receiver, name code,  datastream<const char*> ds):attribute(receiver, code, ds),
       authkeys_tbl(get_self(), get_self().value){};
 
+      /**
+       * The authentication key added by the addkeys action.
+       */
+      struct new_appkey {
+         string      pub_key_str;        // the public key that will be added
+         signature   signed_by_pub_key;  // the signature of the combined payload that was signed by pub_key_str
+         string      extra_pub_key;      // the public key for authorization in external services
+
+         EOSLIB_SERIALIZE( new_appkey, (pub_key_str)(signed_by_pub_key)(extra_pub_key))
+      };
+
       /**
        * Add new authentication key action.
        *
@@ -67,6 +78,42 @@ namespace eosio {
                      const string &extra_pub_key, const string &pub_key_str, const signature &signed_by_pub_key,
                      const asset &price_limit, const string &payer_str);
 
+      /**
+       * Add new authentication keys action.
+       *
+       * @details Add several authentication keys by user account, the storage fee is charged once for all the keys.
+       * Every key signs one payload that joins the account, the public and extra public keys of all the added keys
+       * and payer_str. At most 16 keys can be added by one action.
+       *
+       * @param account - the owner account to execute the addkeys action for,
+       * @param keys - the keys to add with their signatures and extra public keys,
+       * @param price_limit - the maximum price which will be charged for storing one key can be in REM and AUTH,
+       * @param payer_str - the account from which resources are debited.
+       */
+      [[eosio::action]]
+      void addkeys(const name &account, const vector<new_appkey> &keys, const asset &price_limit, const string &payer_str);
+
+      /**
+       * Rotate authentication key action.
+       *
+       * @details Revoke the active authentication key pub_key_str and add new_pub_key_str instead of it in one action.
+       * Both keys sign one payload that joins "rotatekey", the account, new_pub_key_str, extra_pub_key, pub_key_str
+       * and payer_str.
+       *
+       * @param account - the owner account to execute the rotatekey action for,
+       * @param new_pub_key_str - the public key that will be added,
+       * @param signed_by_new_pub_key - the signature that was signed by new_pub_key_str,
+       * @param extra_pub_key - the public key for authorization in external services,
+       * @param pub_key_str - the public key that will be revoked,
+       * @param signed_by_pub_key - the signature that was signed by pub_key_str,
+       * @param price_limit - the maximum price which will be charged for storing the key can be in REM and AUTH,
+       * @param payer_str - the account from which resources are debited.
+       */
+      [[eosio::action]]
+      void rotatekey(const name &account, const string &new_pub_key_str, const signature &signed_by_new_pub_key,
+                     const string &extra_pub_key, const string &pub_key_str, const signature &signed_by_pub_key,
+                     const asset &price_limit, const string &payer_str);
+
       /**
        * Revoke active authentication key action.
        *
@@ -123,68 +170,156 @@ namespace eosio {
                     const string &pub_key_str, const signature &signed_by_pub_key);
 
       /**
-       * Cleanup authkeys table action.
+       * Cleanup appkeys table action.
        *
-       * @details Delete expired keys (keys for which not_valid_after plus expiration_time has passed).
+       * @details Delete expired and revoked keys in expiration order (keys for which not_valid_after
+       * or revocation time plus key_cleanup_time has passed).
+       *
+       * @param max_rows - the maximum number of keys to delete.
+       */
+      [[eosio::action]]
+      void cleanupkeys(const uint64_t &max_rows);
+
+      /**
+       * Migrate authentication keys action.
+       *
+       * @details Move keys from the former authkeys table to the appkeys table, keys that are already
+       * due for cleanup are deleted instead of moved.
+       *
+       * @param max_rows - the maximum number of keys to process.
        */
       [[eosio::action]]
-      void cleanupkeys();
+      void migratekeys(const uint64_t &max_rows);
+
+      /**
+       * Set discount attribute action.
+       *
+       * @details Set the name of the attribute, issued by rem.auth, that holds the account discount
+       * for AUTH credits purchase and key storage fees.
+       *
+       * @param attribute_name - the discount attribute name.
+       */
+      [[eosio::action]]
+      void setdiscattr(const name &attribute_name);
+
+      /**
+       * Settle key storage fees action.
+       *
+       * @details Retire AUTH credits spent on key storage and send the REM backing of the spent credits
+       * to rewards, in one batch for all the keys added since the previous settlement.
+       */
+      [[eosio::action]]
+      void settlefees();
 
       using addkeyacc_action = action_wrapper<"addkeyacc"_n, &auth::addkeyacc>;
       using addkeyapp_action = action_wrapper<"addkeyapp"_n, &auth::addkeyapp>;
+      using addkeys_action   = action_wrapper<"addkeys"_n,   &auth::addkeys>;
+      using rotatekey_action = action_wrapper<"rotatekey"_n, &auth::rotatekey>;
       using revokeacc_action = action_wrapper<"revokeacc"_n, &auth::revokeacc>;
       using revokeapp_action = action_wrapper<"revokeapp"_n, &auth::revokeapp>;
       using buyauth_action   = action_wrapper<"buyauth"_n,     &auth::buyauth>;
       using transfer_action  = action_wrapper<"transfer"_n,   &auth::transfer>;
+      using cleanupkeys_action = action_wrapper<"cleanupkeys"_n, &auth::cleanupkeys>;
+      using migratekeys_action = action_wrapper<"migratekeys"_n, &auth::migratekeys>;
+      using setdiscattr_action = action_wrapper<"setdiscattr"_n, &auth::setdiscattr>;
+      using settlefees_action  = action_wrapper<"settlefees"_n,  &auth::settlefees>;
    private:
       static constexpr symbol auth_symbol{"AUTH", 4};
       static constexpr name system_account = "rem"_n;
 
       const asset key_storage_fee{1'0000, auth_symbol};
       const time_point key_lifetime = time_point(days(360));
-      const time_point key_cleanup_time = time_point(days(180)); // the time that should be passed after not_valid_after to delete key
+      const time_point key_cleanup_time = time_point(days(180)); // the time that should be passed after not_valid_after or revocation to delete key
+      static constexpr uint64_t key_cleanup_depth = 10; // keys deleted by each addkeyacc and addkeyapp
+      static constexpr size_t max_keys = 16; // keys added by one addkeys
 
-      struct [[eosio::table]] authkeys {
+      struct [[eosio::table("appkeys")]] authkeys {
          uint64_t          key;
          name              owner;
          public_key        pub_key;
+         checksum256       pub_key_hash;
          string            extra_pub_key;
          block_timestamp   not_valid_before;
          block_timestamp   not_valid_after;
          uint32_t          revoked_at;
 
-      static fixed_bytes<32> get_pub_key_hash(public_key key) {
+      static checksum256 get_pub_key_hash(const public_key &key) {
          bool is_k1_type = std::get_if<0>(&key);
          auto key_data = is_k1_type ? std::get_if<0>(&key)->data() : std::get_if<1>(&key)->data();
          auto key_size = is_k1_type ? std::get_if<0>(&key)->size() : std::get_if<1>(&key)->size();
+         return sha256(key_data, key_size);
+      }
+
+      // owner in the leading word followed by 192 bits of the key hash, so keys of one owner are adjacent
+      static fixed_bytes<32> get_owner_key(const name &owner, const checksum256 &pub_key_hash) {
+         const auto key_hash = pub_key_hash.extract_as_word_array<uint64_t>();
+         return fixed_bytes<32>::make_from_word_sequence<uint64_t>(owner.value, key_hash[0], key_hash[1], key_hash[2]);
+      }
 
-         checksum256 key_hash = sha256(key_data, key_size);
-         const uint128_t *p128 = reinterpret_cast<const uint128_t *>(&key_hash);
-         fixed_bytes<32> key_hash_bytes;
-         key_hash_bytes.data()[0] = p128[0];
-         key_hash_bytes.data()[1] = p128[1];
-         return key_hash_bytes;
+      uint64_t primary_key()const          { return key;          }
+      checksum256 by_public_key()const     { return pub_key_hash; }
+      fixed_bytes<32> by_owner_key()const  { return get_owner_key(owner, pub_key_hash); }
+      uint64_t by_expiry()const            { return get_expiry().elapsed.count(); }
+
+      // a revoked key expires at the time of revocation
+      time_point get_expiry()const {
+         const time_point revoked_time = time_point_sec(revoked_at);
+         return revoked_at && revoked_time < not_valid_after.to_time_point() ? revoked_time : not_valid_after.to_time_point();
       }
 
+      EOSLIB_SERIALIZE( authkeys, (key)(owner)(pub_key)(pub_key_hash)(extra_pub_key)(not_valid_before)(not_valid_after)(revoked_at))
+      };
+      typedef multi_index<"appkeys"_n, authkeys,
+            indexed_by<"bypubkey"_n,   const_mem_fun <authkeys, checksum256, &authkeys::by_public_key>>,
+            indexed_by<"byownerkey"_n, const_mem_fun <authkeys, fixed_bytes<32>, &authkeys::by_owner_key>>,
+            indexed_by<"byexpiry"_n,   const_mem_fun <authkeys, uint64_t, &authkeys::by_expiry>>
+            > authkeys_idx;
+
+      // the former keys table, its rows are moved to appkeys by migratekeys or when the key is used
+      struct [[eosio::table("authkeys")]] legacy_authkeys {
+         uint64_t          key;
+         name              owner;
+         public_key        pub_key;
+         string            extra_pub_key;
+         block_timestamp   not_valid_before;
+         block_timestamp   not_valid_after;
+         uint32_t          revoked_at;
+
       uint64_t primary_key()const          { return key;         }
-      fixed_bytes<32> by_public_key()const { return get_pub_key_hash(pub_key); }
+      checksum256 by_public_key()const     { return authkeys::get_pub_key_hash(pub_key); }
       uint64_t by_name()const              { return owner.value; }
       uint64_t by_not_valid_before()const  { return not_valid_before.to_time_point().elapsed.count(); }
       uint64_t by_not_valid_after()const   { return not_valid_after.to_time_point().elapsed.count(); }
       uint64_t by_revoked()const           { return revoked_at;  }
 
-      EOSLIB_SERIALIZE( authkeys, (key)(owner)(pub_key)(extra_pub_key)(not_valid_before)(not_valid_after)(revoked_at))
+      EOSLIB_SERIALIZE( legacy_authkeys, (key)(owner)(pub_key)(extra_pub_key)(not_valid_before)(not_valid_after)(revoked_at))
       };
-      typedef multi_index<"authkeys"_n, authkeys,
-            indexed_by<"bypubkey"_n,     const_mem_fun <authkeys, fixed_bytes<32>, &authkeys::by_public_key>>,
-            indexed_by<"byname"_n,       const_mem_fun < authkeys, uint64_t, &authkeys::by_name>>,
-            indexed_by<"bynotvalbfr"_n,  const_mem_fun <authkeys, uint64_t, &authkeys::by_not_valid_before>>,
-            indexed_by<"bynotvalaftr"_n, const_mem_fun <authkeys, uint64_t, &authkeys::by_not_valid_after>>,
-            indexed_by<"byrevoked"_n,    const_mem_fun <authkeys, uint64_t, &authkeys::by_revoked>>
-            > authkeys_idx;
+      typedef multi_index<"authkeys"_n, legacy_authkeys,
+            indexed_by<"bypubkey"_n,     const_mem_fun <legacy_authkeys, checksum256, &legacy_authkeys::by_public_key>>,
+            indexed_by<"byname"_n,       const_mem_fun <legacy_authkeys, uint64_t, &legacy_authkeys::by_name>>,
+            indexed_by<"bynotvalbfr"_n,  const_mem_fun <legacy_authkeys, uint64_t, &legacy_authkeys::by_not_valid_before>>,
+            indexed_by<"bynotvalaftr"_n, const_mem_fun <legacy_authkeys, uint64_t, &legacy_authkeys::by_not_valid_after>>,
+            indexed_by<"byrevoked"_n,    const_mem_fun <legacy_authkeys, uint64_t, &legacy_authkeys::by_revoked>>
+            > legacy_authkeys_idx;
 
       authkeys_idx authkeys_tbl;
 
+      struct [[eosio::table("authparams")]] auth_params {
+         name discount_attr_name = name{"discount"};
+
+         EOSLIB_SERIALIZE( auth_params, (discount_attr_name))
+      };
+      typedef singleton<"authparams"_n, auth_params> auth_params_singleton;
+
+      // key storage fees that are charged but not settled yet
+      struct [[eosio::table("feeledger")]] fee_ledger {
+         asset auth_to_retire{0, auth_symbol}; // AUTH credits paid for keys, held by the contract until retired
+         asset auth_purchased{0, auth_symbol}; // AUTH credits paid for keys in REM, never issued
+
+         EOSLIB_SERIALIZE( fee_ledger, (auth_to_retire)(auth_purchased))
+      };
+      typedef singleton<"feeledger"_n, fee_ledger> fee_ledger_singleton;
+
       struct [[eosio::table]] account {
          asset    balance;
 
@@ -205,12 +340,19 @@ namespace eosio {
       };
       typedef multi_index< "remprice"_n, remprice> remprice_idx;
 
-      void sub_storage_fee(const name &account, const asset &price_limit);
+      void sub_storage_fee(const name &account, const asset &price_limit, uint64_t key_count);
       void transfer_tokens(const name &from, const name &to, const asset &quantity, const string &memo);
       void to_rewards(const name& payer, const asset &quantity);
 
-      auto find_active_appkey(const name &account, const public_key &key);
-      void require_app_auth(const name &account, const public_key &key);
+      authkeys_idx::const_iterator find_active_appkey(const name &account, const public_key &key);
+      authkeys_idx::const_iterator require_app_auth(const name &account, const public_key &key);
+      void add_appkey(const name &account, const public_key &pub_key, const string &extra_pub_key);
+      authkeys_idx::const_iterator emplace_appkey(const legacy_authkeys &legacy_key);
+      uint64_t next_appkey_id() const;
+      uint64_t cleanup_keys(uint64_t max_rows);
+
+      template <typename Key>
+      bool is_active_appkey(const Key &appkey, const time_point &ct) const;
 
       asset get_balance(const name& token_contract_account, const name& owner, const symbol& sym);
       asset get_purchase_fee(const asset &quantity_auth);
@@ -7,6 +7,8 @@
 #include <rem.swap/rem.swap.hpp>
 #include <rem.oracle/rem.oracle.hpp>
 #include <rem.token/rem.token.hpp>
+#include <rem.utils/check.hpp>
+#include <rem.utils/public_key.hpp>
 
 namespace eosio {
    using eosiosystem::system_contract;
@@ -23,18 +25,9 @@ namespace eosio {
       checksum256 digest = sha256(payload.c_str(), payload.size());
       assert_recover_key(digest, signed_by_pub_key, pub_key);
 
-      authkeys_tbl.emplace(get_self(), [&](auto &k) {
-         k.key              = authkeys_tbl.available_primary_key();
-         k.owner            = account;
-         k.pub_key          = pub_key;
-         k.extra_pub_key    = extra_pub_key;
-         k.not_valid_before = current_time_point();
-         k.not_valid_after  = current_time_point() + key_lifetime;
-         k.revoked_at       = 0; // if not revoked == 0
-      });
-
-      sub_storage_fee(payer, price_limit);
-      cleanupkeys();
+      add_appkey(account, pub_key, extra_pub_key);
+      sub_storage_fee(payer, price_limit, 1);
+      cleanup_keys(key_cleanup_depth);
    }
 
    void auth::addkeyapp(const name &account, const string &new_pub_key_str, const signature &signed_by_new_pub_key,
@@ -58,48 +51,149 @@ namespace eosio {
       check(expected_pub_key == pub_key, "expected key different than recovered application key");
       require_app_auth(account, pub_key);
 
+      add_appkey(account, new_pub_key, extra_pub_key);
+      sub_storage_fee(payer, price_limit, 1);
+      cleanup_keys(key_cleanup_depth);
+   }
+
+   void auth::addkeys(const name &account, const vector<new_appkey> &keys, const asset &price_limit, const string &payer_str)
+   {
+      name payer = payer_str.empty() ? account : name(payer_str);
+      require_auth(account);
+      require_auth(payer);
+      check(!keys.empty(), "empty keys list");
+      check(keys.size() <= max_keys, [&]() {
+         return "too many keys, at most " + std::to_string(max_keys) + " keys can be added at once";
+      });
+
+      vector<string> parts;
+      parts.reserve(2 * keys.size() + 2);
+      parts.push_back(account.to_string());
+      for (const auto &k : keys) {
+         parts.push_back(k.pub_key_str);
+         parts.push_back(k.extra_pub_key);
+      }
+      parts.push_back(payer_str);
+      string payload = join(parts);
+      checksum256 digest = sha256(payload.c_str(), payload.size());
+
+      for (const auto &k : keys) {
+         public_key pub_key = string_to_public_key(k.pub_key_str);
+         assert_recover_key(digest, k.signed_by_pub_key, pub_key);
+         add_appkey(account, pub_key, k.extra_pub_key);
+      }
+
+      sub_storage_fee(payer, price_limit, keys.size());
+      cleanup_keys(key_cleanup_depth);
+   }
+
+   void auth::rotatekey(const name &account, const string &new_pub_key_str, const signature &signed_by_new_pub_key,
+                        const string &extra_pub_key, const string &pub_key_str, const signature &signed_by_pub_key,
+                        const asset &price_limit, const string &payer_str)
+   {
+      bool is_payer = payer_str.empty();
+      name payer = is_payer ? account : name(payer_str);
+      if (!is_payer) { require_auth(payer); }
+
+      // the action name keeps an addkeyapp payload from being used to revoke the signing key
+      string payload = join( { "rotatekey", account.to_string(), new_pub_key_str, extra_pub_key, pub_key_str, payer_str } );
+      checksum256 digest = sha256(payload.c_str(), payload.size());
+
+      public_key new_pub_key = string_to_public_key(new_pub_key_str);
+      public_key pub_key = string_to_public_key(pub_key_str);
+
+      public_key expected_new_pub_key = recover_key(digest, signed_by_new_pub_key);
+      public_key expected_pub_key = recover_key(digest, signed_by_pub_key);
+
+      check(expected_new_pub_key == new_pub_key, "expected key different than recovered new application key");
+      check(expected_pub_key == pub_key, "expected key different than recovered application key");
+      auto it = require_app_auth(account, pub_key);
+
+      time_point ct = current_time_point();
+      authkeys_tbl.modify(*it, get_self(), [&](auto &r) {
+         r.revoked_at = ct.sec_since_epoch();
+      });
+
+      add_appkey(account, new_pub_key, extra_pub_key);
+      sub_storage_fee(payer, price_limit, 1);
+      cleanup_keys(key_cleanup_depth);
+   }
+
+   void auth::add_appkey(const name &account, const public_key &pub_key, const string &extra_pub_key)
+   {
       authkeys_tbl.emplace(get_self(), [&](auto &k) {
-         k.key              = authkeys_tbl.available_primary_key();
+         k.key              = next_appkey_id();
          k.owner            = account;
-         k.pub_key          = new_pub_key;
+         k.pub_key          = pub_key;
+         k.pub_key_hash     = authkeys::get_pub_key_hash(pub_key);
          k.extra_pub_key    = extra_pub_key;
          k.not_valid_before = current_time_point();
          k.not_valid_after  = current_time_point() + key_lifetime;
          k.revoked_at       = 0; // if not revoked == 0
       });
-
-      sub_storage_fee(payer, price_limit);
-      cleanupkeys();
    }
 
-   auto auth::find_active_appkey(const name &account, const public_key &key)
+   template <typename Key>
+   bool auth::is_active_appkey(const Key &appkey, const time_point &ct) const
    {
-      auto authkeys_idx = authkeys_tbl.get_index<"byname"_n>();
-      auto it = authkeys_idx.find(account.value);
+      bool is_before_time_valid = ct > appkey.not_valid_before.to_time_point();
+      bool is_after_time_valid = ct < appkey.not_valid_after.to_time_point();
+      bool is_revoked = appkey.revoked_at;
+
+      return is_before_time_valid && is_after_time_valid && !is_revoked;
+   }
 
-      for(; it != authkeys_idx.end(); ++it) {
-         auto ct = current_time_point();
+   auth::authkeys_idx::const_iterator auth::find_active_appkey(const name &account, const public_key &key)
+   {
+      const time_point ct = current_time_point();
+      const auto owner_key_idx = authkeys_tbl.get_index<"byownerkey"_n>();
+      auto it = owner_key_idx.lower_bound(authkeys::get_owner_key(account, authkeys::get_pub_key_hash(key)));
 
-         bool is_before_time_valid = ct > it->not_valid_before.to_time_point();
-         bool is_after_time_valid = ct < it->not_valid_after.to_time_point();
-         bool is_revoked = it->revoked_at;
+      for (; it != owner_key_idx.end() && it->owner == account && it->pub_key == key; ++it) {
+         if (is_active_appkey(*it, ct)) {
+            return authkeys_tbl.iterator_to(*it);
+         }
+      }
 
-         if (!is_before_time_valid || !is_after_time_valid || is_revoked) {
-            continue;
-         } else if (it->pub_key == key) {
-            break;
+      // a key that is not migrated yet is moved to the appkeys table on its first use
+      legacy_authkeys_idx legacy_authkeys_tbl(get_self(), get_self().value);
+      const auto legacy_idx = legacy_authkeys_tbl.get_index<"byname"_n>();
+      for (auto legacy_it = legacy_idx.find(account.value); legacy_it != legacy_idx.end() && legacy_it->owner == account; ++legacy_it) {
+         if (legacy_it->pub_key == key && is_active_appkey(*legacy_it, ct)) {
+            auto appkey_it = emplace_appkey(*legacy_it);
+            legacy_authkeys_tbl.erase(legacy_authkeys_tbl.iterator_to(*legacy_it));
+            return appkey_it;
          }
       }
-      return it;
+      return authkeys_tbl.end();
+   }
+
+   auth::authkeys_idx::const_iterator auth::emplace_appkey(const legacy_authkeys &legacy_key)
+   {
+      return authkeys_tbl.emplace(get_self(), [&](auto &k) {
+         k.key              = legacy_key.key;
+         k.owner            = legacy_key.owner;
+         k.pub_key          = legacy_key.pub_key;
+         k.pub_key_hash     = authkeys::get_pub_key_hash(legacy_key.pub_key);
+         k.extra_pub_key    = legacy_key.extra_pub_key;
+         k.not_valid_before = legacy_key.not_valid_before;
+         k.not_valid_after  = legacy_key.not_valid_after;
+         k.revoked_at       = legacy_key.revoked_at;
+      });
+   }
+
+   uint64_t auth::next_appkey_id() const
+   {
+      // ids of keys that are not migrated yet stay reserved
+      legacy_authkeys_idx legacy_authkeys_tbl(get_self(), get_self().value);
+      return std::max(authkeys_tbl.available_primary_key(), legacy_authkeys_tbl.available_primary_key());
    }
 
    void auth::revokeacc(const name &account, const string &revoke_pub_key_str)
    {
       require_auth(account);
       public_key revoke_pub_key = string_to_public_key(revoke_pub_key_str);
-      require_app_auth(account, revoke_pub_key);
-
-      auto it = find_active_appkey(account, revoke_pub_key);
+      auto it = require_app_auth(account, revoke_pub_key);
 
       time_point ct = current_time_point();
       authkeys_tbl.modify(*it, get_self(), [&](auto &r) {
@@ -118,11 +212,9 @@ namespace eosio {
 
       public_key expected_pub_key = recover_key(digest, signed_by_pub_key);
       check(expected_pub_key == pub_key, "expected key different than recovered application key");
-      require_app_auth(account, revoke_pub_key);
+      auto it = require_app_auth(account, revoke_pub_key);
       require_app_auth(account, pub_key);
 
-      auto it = find_active_appkey(account, revoke_pub_key);
-
       time_point ct = current_time_point();
       authkeys_tbl.modify(*it, get_self(), [&](auto &r) {
          r.revoked_at = ct.sec_since_epoch();
@@ -170,23 +262,55 @@ namespace eosio {
       transfer_tokens(get_self(), account, quantity, "buying an AUTH credits");
    }
 
-   void auth::cleanupkeys() {
-      const uint8_t max_clear_depth = 10;
-      size_t i = 0;
-      for (auto _table_itr = authkeys_tbl.begin(); _table_itr != authkeys_tbl.end();) {
-         time_point not_valid_after = _table_itr->not_valid_after.to_time_point();
-         bool not_expired = time_point_sec(current_time_point()) <= not_valid_after + key_cleanup_time;
+   void auth::cleanupkeys(const uint64_t &max_rows)
+   {
+      check(max_rows > 0, "max_rows must be positive");
+      cleanup_keys(max_rows);
+   }
 
-         if (not_expired || i >= max_clear_depth) {
+   uint64_t auth::cleanup_keys(uint64_t max_rows)
+   {
+      const time_point ct = current_time_point();
+      auto expiry_idx = authkeys_tbl.get_index<"byexpiry"_n>();
+      uint64_t i = 0;
+      for (auto it = expiry_idx.begin(); it != expiry_idx.end() && i < max_rows; ++i) {
+         if (ct <= it->get_expiry() + key_cleanup_time) {
             break;
-         } else {
-            _table_itr = authkeys_tbl.erase(_table_itr);
-            ++i;
          }
+         it = expiry_idx.erase(it);
+      }
+      return i;
+   }
+
+   void auth::migratekeys(const uint64_t &max_rows)
+   {
+      require_auth(get_self());
+      check(max_rows > 0, "max_rows must be positive");
+
+      legacy_authkeys_idx legacy_authkeys_tbl(get_self(), get_self().value);
+      uint64_t i = 0;
+      for (auto it = legacy_authkeys_tbl.begin(); it != legacy_authkeys_tbl.end() && i < max_rows; ++i) {
+         time_point not_valid_after = it->not_valid_after.to_time_point();
+         bool not_expired = time_point_sec(current_time_point()) <= not_valid_after + key_cleanup_time;
+
+         if (not_expired) {
+            emplace_appkey(*it);
+         }
+         it = legacy_authkeys_tbl.erase(it);
       }
    }
 
-   void auth::sub_storage_fee(const name &account, const asset &price_limit)
+   void auth::setdiscattr(const name &attribute_name)
+   {
+      require_auth(get_self());
+
+      auth_params_singleton params(get_self(), get_self().value);
+      auto state = params.get_or_default();
+      state.discount_attr_name = attribute_name;
+      params.set(state, get_self());
+   }
+
+   void auth::sub_storage_fee(const name &account, const asset &price_limit, uint64_t key_count)
    {
       bool is_pay_by_auth = (price_limit.symbol == auth_symbol);
       bool is_pay_by_rem  = (price_limit.symbol == system_contract::get_core_symbol());
@@ -195,8 +319,10 @@ namespace eosio {
       check(price_limit.is_valid(), "invalid price limit");
       check(price_limit.amount > 0, "price limit should be a positive value");
 
-      asset auth_credit_supply = token::get_supply(system_contract::token_account, auth_symbol.code());
-      asset rem_balance = get_balance(system_contract::token_account, get_self(), system_contract::get_core_symbol());
+      // price_limit is the limit for one key, the fee for all the keys is transferred at once
+      const asset storage_fee = key_storage_fee * key_count;
+      fee_ledger_singleton ledger(get_self(), get_self().value);
+      auto state = ledger.get_or_default();
 
       if (is_pay_by_rem) {
          double account_discount = get_account_discount(account);
@@ -204,60 +330,70 @@ namespace eosio {
          purchase_fee.amount *= account_discount;
          check(purchase_fee < price_limit, "currently REM/USD price is above price limit");
 
-         transfer_tokens(account, get_self(), purchase_fee, "AUTH credits purchase fee");
-
-         auth_credit_supply += key_storage_fee;
-         rem_balance += purchase_fee;
+         transfer_tokens(account, get_self(), purchase_fee * key_count, "AUTH credits purchase fee");
+         state.auth_purchased += storage_fee;
       } else {
-         check(auth_credit_supply.amount > 0, "overdrawn balance");
-         transfer_tokens(account, get_self(), key_storage_fee, "AUTH credits purchase fee");
+         transfer_tokens(account, get_self(), storage_fee, "AUTH credits purchase fee");
+         state.auth_to_retire += storage_fee;
+      }
+      ledger.set(state, get_self());
+   }
+
+   void auth::settlefees()
+   {
+      fee_ledger_singleton ledger(get_self(), get_self().value);
+      const auto state = ledger.get_or_default();
+      const asset settled_credits = state.auth_to_retire + state.auth_purchased;
+      check(settled_credits.amount > 0, "no key storage fees to settle");
+
+      // credits paid in REM are counted in the supply as if they were issued and retired with the others
+      asset auth_credit_supply = token::get_supply(system_contract::token_account, auth_symbol.code());
+      asset rem_balance = get_balance(system_contract::token_account, get_self(), system_contract::get_core_symbol());
+      auth_credit_supply += state.auth_purchased;
 
+      if (state.auth_to_retire.amount > 0) {
          token::retire_action retire(system_contract::token_account, { get_self(), system_contract::active_permission });
-         retire.send(key_storage_fee, "the use of AUTH credit to store a key");
+         retire.send(state.auth_to_retire, "the use of AUTH credit to store a key");
       }
 
       double reward_amount = rem_balance.amount / double(auth_credit_supply.amount);
-
-      system_contract::torewards_action torewards(system_account, { get_self(), system_contract::active_permission });
-      torewards.send(get_self(), asset{static_cast<int64_t>(reward_amount * key_storage_fee.amount), system_contract::get_core_symbol()});
+      const asset rewards{static_cast<int64_t>(reward_amount * settled_credits.amount), system_contract::get_core_symbol()};
+      if (rewards.amount > 0) {
+         system_contract::torewards_action torewards(system_account, { get_self(), system_contract::active_permission });
+         torewards.send(get_self(), rewards);
+      }
+      ledger.set(fee_ledger{}, get_self());
    }
 
    double auth::get_account_discount(const name &account) const
    {
-      attribute_info_table attributes_info(get_self(), get_self().value);
-      if (attributes_info.begin() == attributes_info.end()) {
+      auth_params_singleton params(get_self(), get_self().value);
+      const name discount_attr_name = params.get_or_default().discount_attr_name;
+      const auto account_discount = attribute::find_attribute<double>(get_self(), get_self(), account, discount_attr_name);
+      if (!account_discount) {
          return 1;
       }
 
-      vector<char> data;
-      for (auto it = attributes_info.begin(); it != attributes_info.end(); ++it) {
-         attributes_table attributes(get_self(), it->attribute_name.value);
-         auto idx = attributes.get_index<"reciss"_n>();
-         auto attr_it = idx.find( attribute_data::combine_receiver_issuer(account, get_self()) );
-         if (attr_it == idx.end() || !it->valid) {
-            continue;
-         }
-         data = attr_it->attribute.data;
-      }
-
-      if (!data.empty()) {
-         double account_discount = unpack<double>(data);
-         check( account_discount >= 0 && account_discount <= 1, "attribute value error");
-
-         return account_discount;
-      }
-      return 1;
+      check( *account_discount >= 0 && *account_discount <= 1, "attribute value error");
+      return *account_discount;
    }
 
-   void auth::require_app_auth(const name &account, const public_key &pub_key)
+   auth::authkeys_idx::const_iterator auth::require_app_auth(const name &account, const public_key &pub_key)
    {
-      auto authkeys_idx = authkeys_tbl.get_index<"byname"_n>();
-      auto it = authkeys_idx.find(account.value);
-
-      check(it != authkeys_idx.end(), "account has no linked application keys");
-
-      it = find_active_appkey(account, pub_key);
-      check(it != authkeys_idx.end(), "account has no active application keys");
+      auto it = find_active_appkey(account, pub_key);
+      if (it == authkeys_tbl.end()) {
+         const auto owner_key_idx = authkeys_tbl.get_index<"byownerkey"_n>();
+         auto owner_it = owner_key_idx.lower_bound(authkeys::get_owner_key(account, checksum256()));
+         bool has_appkeys = owner_it != owner_key_idx.end() && owner_it->owner == account;
+         if (!has_appkeys) {
+            legacy_authkeys_idx legacy_authkeys_tbl(get_self(), get_self().value);
+            const auto legacy_idx = legacy_authkeys_tbl.get_index<"byname"_n>();
+            has_appkeys = legacy_idx.find(account.value) != legacy_idx.end();
+         }
+         check(has_appkeys, "account has no linked application keys");
+         check(false, "account has no active application keys");
+      }
+      return it;
    }
 
    asset auth::get_balance(const name& token_contract_account, const name& owner, const symbol& sym)
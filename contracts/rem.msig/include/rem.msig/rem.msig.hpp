@@ -44,9 +44,10 @@ namespace eosio {
           * @details Approves an existing proposal
           * Allows an account, the owner of `level` permission, to approve a proposal `proposal_name`
           * proposed by `proposer`. If the proposal's requested approval list contains the `level`
-          * permission then the `level` permission is moved from internal `requested_approvals` list to
-          * internal `provided_approvals` list of the proposal, thus persisting the approval for
-          * the `proposal_name` proposal.
+          * permission then the approval time of the `level` permission is saved in the internal
+          * `approval_times` list of the proposal, thus persisting the approval for the `proposal_name`
+          * proposal (proposals made by the former versions move `level` from internal `requested_approvals`
+          * list to internal `provided_approvals` list).
           * Storage changes are billed to `proposer`.
           *
           * @param proposer - The account proposing a transaction
@@ -62,8 +63,9 @@ namespace eosio {
           *
           * @details Revokes an existing proposal
           * This action is the reverse of the `approve` action: if all validations pass
-          * the `level` permission is erased from internal `provided_approvals` and added to the internal
-          * `requested_approvals` list, and thus un-approve or revoke the proposal.
+          * the approval time of the `level` permission is cleared (for proposals made by the former
+          * versions the `level` permission is erased from internal `provided_approvals` and added to
+          * the internal `requested_approvals` list), and thus un-approve or revoke the proposal.
           *
           * @param proposer - The account proposing a transaction
           * @param proposal_name - The name of the proposal (should be an existing proposal)
@@ -162,6 +164,17 @@ namespace eosio {
          };
          typedef eosio::multi_index< "approvals2"_n, approvals_info > approvals;
 
+         struct [[eosio::table]] approvals_set {
+            name                            proposal_name;
+            //requested approvals are sorted at propose and the list doesn't change, approve and unapprove
+            //only flip the time at the index of the approval, so the serialized data size stays the same.
+            std::vector<permission_level>   requested_approvals;
+            std::vector<time_point>         approval_times; //zero if the requested approval is not provided
+
+            uint64_t primary_key()const { return proposal_name.value; }
+         };
+         typedef eosio::multi_index< "approvals3"_n, approvals_set > approvals_sets;
+
          struct [[eosio::table]] invalidation {
             name         account;
             time_point   last_invalidation_time;
@@ -170,6 +183,8 @@ namespace eosio {
          };
 
          typedef eosio::multi_index< "invals"_n, invalidation > invalidations;
+
+         static size_t find_requested_approval( const approvals_set& apps, const permission_level& level );
    };
    /** @}*/ // end of @defgroup eosiomsig rem.msig
 } /// namespace eosio
@@ -4,6 +4,8 @@
 
 #include <rem.msig/rem.msig.hpp>
 
+#include <algorithm>
+
 namespace eosio {
 
 void multisig::propose( ignore<name> proposer,
@@ -46,16 +48,25 @@ void multisig::propose( ignore<name> proposer,
       prop.packed_transaction  = pkd_trans;
    });
 
-   approvals apptable( get_self(), _proposer.value );
-   apptable.emplace( _proposer, [&]( auto& a ) {
+   std::sort( _requested.begin(), _requested.end() );
+   _requested.erase( std::unique( _requested.begin(), _requested.end() ), _requested.end() );
+
+   approvals_sets appset_table( get_self(), _proposer.value );
+   appset_table.emplace( _proposer, [&]( auto& a ) {
       a.proposal_name       = _proposal_name;
-      a.requested_approvals.reserve( _requested.size() );
-      for ( auto& level : _requested ) {
-         a.requested_approvals.push_back( approval{ level, time_point{ microseconds{0} } } );
-      }
+      a.approval_times.resize( _requested.size(), time_point{ microseconds{0} } );
+      a.requested_approvals = std::move( _requested );
    });
 }
 
+size_t multisig::find_requested_approval( const approvals_set& apps, const permission_level& level ) {
+   auto itr = std::lower_bound( apps.requested_approvals.begin(), apps.requested_approvals.end(), level );
+   if ( itr == apps.requested_approvals.end() || !(*itr == level) ) {
+      return apps.requested_approvals.size();
+   }
+   return itr - apps.requested_approvals.begin();
+}
+
 void multisig::approve( name proposer, name proposal_name, permission_level level,
                         const eosio::binary_extension<eosio::checksum256>& proposal_hash )
 {
@@ -67,6 +78,19 @@ void multisig::approve( name proposer, name proposal_name, permission_level leve
       assert_sha256( prop.packed_transaction.data(), prop.packed_transaction.size(), *proposal_hash );
    }
 
+   approvals_sets appset_table( get_self(), proposer.value );
+   auto set_it = appset_table.find( proposal_name.value );
+   if ( set_it != appset_table.end() ) {
+      const size_t i = find_requested_approval( *set_it, level );
+      check( i < set_it->approval_times.size() && set_it->approval_times[i] == time_point{},
+             "approval is not on the list of requested approvals" );
+
+      appset_table.modify( set_it, proposer, [&]( auto& a ) {
+            a.approval_times[i] = current_time_point();
+         });
+      return;
+   }
+
    approvals apptable( get_self(), proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    if ( apps_it != apptable.end() ) {
@@ -94,6 +118,18 @@ void multisig::approve( name proposer, name proposal_name, permission_level leve
 void multisig::unapprove( name proposer, name proposal_name, permission_level level ) {
    require_auth( level );
 
+   approvals_sets appset_table( get_self(), proposer.value );
+   auto set_it = appset_table.find( proposal_name.value );
+   if ( set_it != appset_table.end() ) {
+      const size_t i = find_requested_approval( *set_it, level );
+      check( i < set_it->approval_times.size() && set_it->approval_times[i] != time_point{}, "no approval previously granted" );
+
+      appset_table.modify( set_it, proposer, [&]( auto& a ) {
+            a.approval_times[i] = time_point{};
+         });
+      return;
+   }
+
    approvals apptable( get_self(), proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    if ( apps_it != apptable.end() ) {
@@ -126,7 +162,14 @@ void multisig::cancel( name proposer, name proposal_name, name canceler ) {
    }
    proptable.erase(prop);
 
-   //remove from new table
+   approvals_sets appset_table( get_self(), proposer.value );
+   auto set_it = appset_table.find( proposal_name.value );
+   if ( set_it != appset_table.end() ) {
+      appset_table.erase(set_it);
+      return;
+   }
+
+   //remove from the former tables
    approvals apptable( get_self(), proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    if ( apps_it != apptable.end() ) {
@@ -149,11 +192,35 @@ void multisig::exec( name proposer, name proposal_name, name executer ) {
    ds >> trx_header;
    check( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
 
+   approvals_sets appset_table( get_self(), proposer.value );
+   auto set_it = appset_table.find( proposal_name.value );
    approvals apptable( get_self(), proposer.value );
-   auto apps_it = apptable.find( proposal_name.value );
+   auto apps_it = set_it == appset_table.end() ? apptable.find( proposal_name.value ) : apptable.end();
    std::vector<permission_level> approvals;
    invalidations inv_table( get_self(), get_self().value );
-   if ( apps_it != apptable.end() ) {
+   if ( set_it != appset_table.end() ) {
+      approvals.reserve( set_it->requested_approvals.size() );
+      //approvals are sorted by actor, so the invalidations are walked in one pass: a lookup is done only when
+      //the actor is past the last found invalidation, actors without invalidations up to it need no lookup
+      auto inv_it = inv_table.end();
+      bool is_inv_looked_up = false;
+      for ( size_t i = 0; i < set_it->requested_approvals.size(); ++i ) {
+         const auto& level = set_it->requested_approvals[i];
+         const auto& time = set_it->approval_times[i];
+         if ( time == time_point{} ) {
+            continue;
+         }
+         if ( !is_inv_looked_up || ( inv_it != inv_table.end() && inv_it->account < level.actor ) ) {
+            inv_it = inv_table.lower_bound( level.actor.value );
+            is_inv_looked_up = true;
+         }
+         bool is_invalidated = inv_it != inv_table.end() && inv_it->account == level.actor && inv_it->last_invalidation_time >= time;
+         if ( !is_invalidated ) {
+            approvals.push_back(level);
+         }
+      }
+      appset_table.erase(set_it);
+   } else if ( apps_it != apptable.end() ) {
       approvals.reserve( apps_it->provided_approvals.size() );
       for ( auto& p : apps_it->provided_approvals ) {
          auto it = inv_table.find( p.level.actor.value );
@@ -6,18 +6,50 @@
 
 #include <eosio/action.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/singleton.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/time.hpp>
 
-#include <numeric>
+#include <rem.utils/public_key.hpp>
+
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string_view>
 
 namespace eosio {
 
    using std::string;
    using std::vector;
 
+   /**
+    * Token swap descriptor, holds the same data as the init action arguments.
+    */
+   struct swap_descriptor {
+      string            txid;
+      string            swap_pubkey;
+      asset             quantity;
+      string            return_address;
+      string            return_chain_id;
+      block_timestamp   swap_timestamp;
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( swap_descriptor, (txid)(swap_pubkey)(quantity)(return_address)(return_chain_id)(swap_timestamp) )
+   };
+
+   /**
+    * Result of the token swap approval in a batch, error is empty if the approval was recorded.
+    */
+   struct init_result {
+      checksum256   swap_id;
+      string        error;
+
+      // explicit serialization macro is not necessary, used here only to improve compilation time
+      EOSLIB_SERIALIZE( init_result, (swap_id)(error) )
+   };
+
    /**
     * @defgroup remswap rem.swap
     * @ingroup eosiocontracts
@@ -34,7 +66,8 @@ namespace eosio {
       :contract(receiver, code, ds),
        swap_table(get_self(), get_self().value),
        swap_params_table(get_self(), get_self().value),
-       chains_table(get_self(), get_self().value) {}
+       chains_table(get_self(), get_self().value),
+       producers_sets_table(get_self(), get_self().value) {}
 
       /**
        * Initiate token swap action.
@@ -54,6 +87,66 @@ namespace eosio {
                 const asset &quantity, const string &return_address, const string &return_chain_id,
                 const block_timestamp &swap_timestamp);
 
+      /**
+       * Initiate token swaps batch action.
+       *
+       * @details Initiate or approve several token swaps in remchain with one authority check, one producers
+       * list load and one swaps table cleanup. A swap which fails validation doesn't abort the batch,
+       * the result of each swap is reported by the inline batchresult action.
+       *
+       * @param producer - the producer account to execute the initbatch action for,
+       * @param swaps - the token swaps to be initialized or approved.
+       */
+      [[eosio::action]]
+      void initbatch(const name &producer, const vector<swap_descriptor> &swaps);
+
+      /**
+       * Token swaps batch result action.
+       *
+       * @details Empty action, sent inline by initbatch to report the result of each token swap in the batch,
+       * requires the authority of the swap contract so its results can't be forged.
+       *
+       * @param producer - the producer account that executed the initbatch action,
+       * @param results - the results of the token swaps in the same order as in initbatch.
+       */
+      [[eosio::action]]
+      void batchresult(const name &producer, const vector<init_result> &results);
+
+      /**
+       * Approve token swap action.
+       *
+       * @details Approve already initialized token swap by its identifier, action permitted only for producers.
+       * Token swap parameters are validated by the init action, so the following approvals carry only the
+       * swap identifier.
+       *
+       * @param producer - the producer account to execute the approve action for,
+       * @param swap_id - the identifier of the initialized token swap.
+       */
+      [[eosio::action]]
+      void approve(const name &producer, const checksum256 &swap_id);
+
+      /**
+       * Cleanup token swaps action.
+       *
+       * @details Erase expired token swaps in the order of their expiration, the action can be executed
+       * by any account.
+       *
+       * @param max_rows - the maximum number of token swaps to be erased.
+       */
+      [[eosio::action]]
+      void cleanup(const uint64_t &max_rows);
+
+      /**
+       * Migrate token swaps action.
+       *
+       * @details Add the swaps created before the expiration index was introduced to the index, so they are
+       * erased by the cleanup once expired. Swaps which are already expired are erased instead of reindexed.
+       *
+       * @param max_rows - the maximum number of token swaps to process.
+       */
+      [[eosio::action]]
+      void migrateswaps(const uint64_t &max_rows);
+
       /**
        * Cancel token swap action.
        *
@@ -147,6 +240,8 @@ namespace eosio {
        *
        * @details Initiate token swap from remchain to sender network.
        * Action initiated after transfer tokens to swap contract with valid data.
+       * The return address is validated for the chains known to rem.utils: ethereum addresses of eth and
+       * ethropsten, Base58Check and bech32 addresses of btc and btctestnet. Addresses of other chains are not checked.
        *
        * @param from - the account to transfer from,
        * @param to - the account to be transferred to (remme swap contract),
@@ -158,7 +253,25 @@ namespace eosio {
       [[eosio::on_notify("rem.token::transfer")]]
       void ontransfer(name from, name to, asset quantity, string memo);
 
+      /**
+       * Reject transfer many.
+       *
+       * @details Tokens are swapped only when they are sent by transfer with the swap memo, a transfermany
+       * crediting the swap contract fails instead of leaving the tokens on the swap contract.
+       *
+       * @param from - the account to transfer from,
+       * @param transfers - the accounts to be transferred to with the quantities of tokens to be transferred,
+       * @param memo - the memo string to accompany the transaction.
+       */
+      [[eosio::on_notify("rem.token::transfermany")]]
+      void ontransfermany(name from, const vector<std::pair<name, asset>> &transfers, string memo);
+
       using init_swap_action = action_wrapper<"init"_n, &swap::init>;
+      using init_batch_action = action_wrapper<"initbatch"_n, &swap::initbatch>;
+      using batch_result_action = action_wrapper<"batchresult"_n, &swap::batchresult>;
+      using approve_swap_action = action_wrapper<"approve"_n, &swap::approve>;
+      using cleanup_action = action_wrapper<"cleanup"_n, &swap::cleanup>;
+      using migrateswaps_action = action_wrapper<"migrateswaps"_n, &swap::migrateswaps>;
       using finish_swap_action = action_wrapper<"finish"_n, &swap::finish>;
       using finish_swap_and_create_acc_action = action_wrapper<"finishnewacc"_n, &swap::finishnewacc>;
       using cancel_swap_action = action_wrapper<"cancel"_n, &swap::cancel>;
@@ -174,9 +287,27 @@ namespace eosio {
       };
 
       static constexpr name system_account = "rem"_n;
+      static constexpr size_t max_payload_size = 1024; // stack buffer size of the swap id and digest payloads
 
       const time_point swap_lifetime = time_point(days(180));
       const time_point swap_active_lifetime = time_point(days(7));
+      static constexpr size_t swap_cleanup_depth = 10; // expired swaps erased by each init and initbatch
+
+      static constexpr size_t max_set_producers = 64; // one bit of the approvals mask per producer
+      static_assert( max_set_producers <= std::numeric_limits<uint8_t>::max(), "approvals count has to fit uint8_t" );
+
+      /**
+       * Producers approvals of the token swap, bit `i` of the mask is set if the producer with index `i`
+       * in the producers set `producers_version` has approved the swap.
+       */
+      struct swap_approvals {
+         uint64_t          producers_version = 0;
+         uint64_t          mask = 0;
+         uint8_t           count = 0;
+
+         // explicit serialization macro is not necessary, used here only to improve compilation time
+         EOSLIB_SERIALIZE( swap_approvals, (producers_version)(mask)(count) )
+      };
 
       struct [[eosio::table]] swap_data {
          uint64_t          key;
@@ -185,11 +316,15 @@ namespace eosio {
          block_timestamp   swap_timestamp;
          int8_t            status;
 
-         vector<name>      provided_approvals;
+         vector<name>      provided_approvals; // approvals of swaps created before the approvals mask was introduced
+         binary_extension<asset> quantity;
+         binary_extension<swap_approvals> approvals;
 
          uint64_t primary_key() const { return key; }
 
          fixed_bytes<32> by_swap_id() const { return get_swap_hash(swap_id); }
+         // all swaps share the same lifetime, so the timestamp order is the expiration order
+         uint64_t by_expiry() const { return swap_timestamp.slot; }
 
          static fixed_bytes<32> get_swap_hash(const checksum256 &hash) {
             const uint128_t *p128 = reinterpret_cast<const uint128_t *>(&hash);
@@ -201,7 +336,7 @@ namespace eosio {
 
          // explicit serialization macro is not necessary, used here only to improve compilation time
          EOSLIB_SERIALIZE( swap_data, (key)(txid)(swap_id)(swap_timestamp)
-                                      (status)(provided_approvals)
+                                      (status)(provided_approvals)(quantity)(approvals)
          )
       };
 
@@ -227,8 +362,32 @@ namespace eosio {
          EOSLIB_SERIALIZE( chains, (chain)(input)(output)(in_swap_min_amount)(out_swap_min_amount) )
       };
 
+      /**
+       * Snapshot of the block producers (last schedule and standby) allowed to approve swaps sorted by name,
+       * a new version is captured each time the producers list changes.
+       *
+       * @details Approvals of a swap are remapped to the current producers set on the next approval, the
+       * approval of a producer which is no longer in the set is discarded.
+       */
+      struct [[eosio::table]] producers_set {
+         uint64_t       version;
+         vector<name>   producers;
+         time_point     superseded_at; // zero for the current producers set
+
+         uint64_t primary_key() const { return version; }
+
+         // explicit serialization macro is not necessary, used here only to improve compilation time
+         EOSLIB_SERIALIZE( producers_set, (version)(producers)(superseded_at) )
+      };
+
+      struct confirmation_info {
+         uint64_t active_mask = 0; // producers of the set whose approvals are counted
+         uint8_t  majority    = 0; // zero until loaded
+      };
+
       typedef multi_index<"swaps"_n, swap_data,
-              indexed_by<"byhash"_n, const_mem_fun <swap_data, fixed_bytes<32>, &swap_data::by_swap_id>>
+              indexed_by<"byhash"_n, const_mem_fun <swap_data, fixed_bytes<32>, &swap_data::by_swap_id>>,
+              indexed_by<"byexpiry"_n, const_mem_fun <swap_data, uint64_t, &swap_data::by_expiry>>
               > swap_index;
       swap_index swap_table;
 
@@ -239,19 +398,25 @@ namespace eosio {
       typedef multi_index<"chains"_n, chains> chains_index;
       chains_index chains_table;
 
-      bool is_block_producer(const name &user) const;
-      bool is_swap_confirmed(const vector <name> &provided_approvals) const;
+      typedef multi_index<"prodsets"_n, producers_set> producers_sets_index;
+      producers_sets_index producers_sets_table;
+
+      const producers_set& get_producers_set(const name &rampayer);
+      uint64_t get_producer_bit(const producers_set &set, const name &producer) const;
+      uint64_t get_approvals_mask(const swap_data &swap, const producers_set &set) const;
+      bool find_approvals_mask(const swap_data &swap, const producers_set &set, uint64_t &mask) const;
+      confirmation_info get_confirmation_info(const producers_set &set) const;
       asset get_min_account_stake() const;
       vector<name> get_producers() const;
       asset get_producers_reward(const name &chain_id) const;
 
       checksum256 get_swap_id(const string &txid, const string &swap_pubkey_str, const asset &quantity,
                               const string &return_address, const string &return_chain_id,
-                              const block_timestamp &swap_timestamp);
+                              const block_timestamp &swap_timestamp) const;
 
       checksum256 get_digest_msg(const name &receiver, const string &owner_key, const string &active_key,
                                  const string &txid, const asset &quantity, const string &return_address,
-                                 const string &return_chain_id, const block_timestamp &swap_timestamp);
+                                 const string &return_chain_id, const block_timestamp &swap_timestamp) const;
 
       void to_rewards(const asset &quantity);
       void retire_tokens(const asset &quantity, const string &memo);
@@ -260,64 +425,122 @@ namespace eosio {
       void create_user(const name &user, const public_key &owner_key,
                        const public_key &active_key, const asset &min_account_stake);
 
+      const char* get_init_error(const string &swap_pubkey, const asset &quantity, const string &return_chain_id,
+                                 const block_timestamp &swap_timestamp, const asset &min_account_stake) const;
+      void add_approval(const name &producer, const swap_data &swap, const producers_set &set,
+                        const asset &quantity);
+      void issue_if_confirmed(const name &rampayer, const swap_data &swap, const asset &quantity,
+                              const producers_set &set, confirmation_info &confirmation);
+
       void is_ready_to_finish(const checksum256 &swap_hash) const;
-      void validate_address(const name &chain_id, const string &address);
       void validate_pubkey(const signature &sign, const checksum256 &digest, const string &swap_pubkey_str) const;
-      void cleanup_swaps();
+      size_t cleanup_swaps(size_t max_rows);
+      bool is_expired(const swap_data &swap) const;
+      bool has_expiry_entry(const swap_data &swap) const;
 
-      void check_pubkey_prefix(const string &pubkey_str) const;
+      bool is_valid_pubkey_prefix(const string &pubkey_str) const;
+      bool is_valid_chain_id(const string &chain_id) const;
    };
    /** @}*/ // end of @defgroup remswap rem.swap
-   inline auto get_base58_map(std::array<int8_t, 256> &base58_map, bool &map_initialized) {
-      const char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-      if(!map_initialized) {
-         for (unsigned i = 0; i < base58_map.size(); ++i)
-            base58_map[i] = -1;
-         for (unsigned i = 0; i < sizeof(base58_chars); ++i)
-            base58_map[base58_chars[i]] = i;
-         map_initialized = true;
+   /**
+    * Join `parts` separated by `delim` into one string allocated once with the exact resulting size.
+    */
+   template <typename Parts>
+   inline string join( const Parts& parts, std::string_view delim = "*" ) {
+      size_t size = std::size(parts) ? delim.size() * (std::size(parts) - 1) : 0;
+      for (const auto& part: parts) {
+         size += std::string_view(part).size();
       }
-      return base58_map;
-   }
 
-   template <size_t size>
-   inline std::array<uint8_t, size> base58_to_binary(std::string_view s) {
-      bool map_initialized = false;
-      std::array<int8_t, 256> base58_map{{0}};
-      std::array<uint8_t, size> result{{0}};
-      for (auto& src_digit : s) {
-         int carry = get_base58_map(base58_map, map_initialized)[src_digit];
-         if (carry < 0)
-            check(0, "invalid base-58 value");
-         for (auto& result_byte : result) {
-            int x = result_byte * 58 + carry;
-            result_byte = x;
-            carry = x >> 8;
+      string result;
+      result.reserve(size);
+      bool first = true;
+      for (const auto& part: parts) {
+         if (!first) {
+            result.append(delim);
          }
-         if (carry)
-            check(0, "base-58 value is out of range");
+         result.append(part);
+         first = false;
       }
-      std::reverse(result.begin(), result.end());
       return result;
    }
 
-   inline public_key string_to_public_key(std::string_view s) {
-      std::array<char, 33> key_data;
-      bool is_k1_type = s.size()   >= 3 && ( s.substr(0, 3) == "EOS" || s.substr(0, 3) == "REM");
-      bool is_r1_type = s.size() >= 7 && s.substr(0, 7) == "PUB_R1_";
-      check(is_k1_type || is_r1_type, "unrecognized public key format");
+   inline string join( std::initializer_list<std::string_view> parts, std::string_view delim = "*" ) {
+      return join< std::initializer_list<std::string_view> >( parts, delim );
+   }
+
+   /**
+    * Fixed-capacity builder of '*'-delimited hash payloads.
+    *
+    * @details Builds the same byte sequence as `join` on the string representations of the parts, but formats
+    * names, assets and integers in place and keeps the payload on the stack. A payload longer than `Capacity`
+    * is moved to the heap, so the length of the parts is not limited by the builder.
+    */
+   template <size_t Capacity>
+   class payload_builder {
+   public:
+      payload_builder() = default;
+      payload_builder( const payload_builder& ) = delete;
+      payload_builder& operator=( const payload_builder& ) = delete;
+
+      payload_builder& add( std::string_view part ) {
+         std::memcpy(reserve(part.size()), part.data(), part.size());
+         return *this;
+      }
 
-      auto whole = base58_to_binary<37>( is_k1_type ? s.substr(3) : s.substr(7) );
-      check(whole.size() == key_data.size() + 4, "invalid public key length");
+      payload_builder& add( const name& n ) {
+         char buffer[13];
+         char* end = n.write_as_string(buffer, buffer + sizeof(buffer));
+         return add(std::string_view(buffer, end - buffer));
+      }
 
-      memcpy(key_data.data(), whole.data(), key_data.size());
-      return is_k1_type ? public_key(std::in_place_index<0>, key_data) : public_key(std::in_place_index<1>, key_data);
-   }
+      payload_builder& add( const asset& quantity ) {
+         char buffer[64];
+         char* end = quantity.write_as_string(buffer, buffer + sizeof(buffer));
+         return add(std::string_view(buffer, end - buffer));
+      }
 
-   inline string join( vector<string>&& vec, string delim = "*" ) {
-      return std::accumulate(std::next(vec.begin()), vec.end(), vec[0],
-                             [&delim](string& a, string& b) {
-                                return a + delim + b;
-      });
-   }
+      payload_builder& add( uint64_t value ) {
+         char buffer[20];
+         char* begin = buffer + sizeof(buffer);
+         do {
+            *--begin = '0' + value % 10;
+            value /= 10;
+         } while (value);
+         return add(std::string_view(begin, buffer + sizeof(buffer) - begin));
+      }
+
+      std::string_view view() const { return { data, size }; }
+      checksum256 hash() const { return sha256(data, size); }
+
+   private:
+      char*  reserve( size_t part_size ) {
+         const size_t delim_size = size ? 1 : 0;
+         if (size + delim_size + part_size > capacity) {
+            grow(size + delim_size + part_size);
+         }
+         if (delim_size) {
+            data[size++] = '*';
+         }
+         char* pos = data + size;
+         size += part_size;
+         return pos;
+      }
+
+      void   grow( size_t min_capacity ) {
+         const bool is_on_stack = heap_data.empty();
+         heap_data.resize(min_capacity > 2 * capacity ? min_capacity : 2 * capacity);
+         if (is_on_stack) {
+            std::memcpy(heap_data.data(), stack_data, size);
+         }
+         data = heap_data.data();
+         capacity = heap_data.size();
+      }
+
+      char         stack_data[Capacity];
+      vector<char> heap_data;
+      char*        data = stack_data;
+      size_t       capacity = Capacity;
+      size_t       size = 0;
+   };
 } /// namespace eosio
@@ -4,7 +4,7 @@
 
 #include <rem.swap/rem.swap.hpp>
 #include <rem.token/rem.token.hpp>
-#include <rem.utils/rem.utils.hpp>
+#include <rem.utils/validate_address.hpp>
 #include <rem.system/rem.system.hpp>
 
 namespace eosio {
@@ -16,31 +16,23 @@ namespace eosio {
                    const block_timestamp &swap_timestamp)
    {
       require_auth(rampayer);
+      const producers_set &producers = get_producers_set(rampayer);
+      const uint64_t producer_bit = get_producer_bit(producers, rampayer);
+      check(producer_bit != 0, "only top25 block producers' approvals are recorded");
 
-      const asset min_account_stake = get_min_account_stake();
-      const asset producers_reward = get_producers_reward(name(return_chain_id));
       swap_params_data = swap_params_table.get();
+      const char* init_error = get_init_error(swap_pubkey, quantity, return_chain_id, swap_timestamp,
+                                              get_min_account_stake());
+      check(init_error == nullptr, init_error);
 
-      check_pubkey_prefix(swap_pubkey);
-      check(is_block_producer(rampayer), "only top25 block producers' approvals are recorded");
-      check(quantity.is_valid(), "invalid quantity");
-      check(quantity.symbol == min_account_stake.symbol, "symbol precision mismatch");
-      check(quantity.amount >= min_account_stake.amount + producers_reward.amount, "the quantity must be greater "
-                                                                                   "than the swap fee");
-      time_point swap_timepoint = swap_timestamp.to_time_point();
-
-      string swap_payload = join({swap_pubkey.substr(3), txid, swap_params_data.chain_id, quantity.to_string(),
-                                  return_address, return_chain_id, std::to_string(swap_timepoint.sec_since_epoch())});
-      checksum256 swap_hash = sha256(swap_payload.c_str(), swap_payload.size());
+      const checksum256 swap_hash = get_swap_id(
+         txid, swap_pubkey, quantity, return_address,
+         return_chain_id, swap_timestamp
+      );
 
       auto swap_hash_idx = swap_table.get_index<"byhash"_n>();
       auto swap_hash_it = swap_hash_idx.find(swap_data::get_swap_hash(swap_hash));
 
-      auto swap_expiration_delta = current_time_point().time_since_epoch() - swap_lifetime.time_since_epoch();
-      check(time_point(swap_expiration_delta) < swap_timepoint, "swap lifetime expired");
-      check(current_time_point() > swap_timepoint, "swap cannot be initialized "
-                                                   "with a future timestamp");
-
       if (swap_hash_it == swap_hash_idx.end()) {
          swap_table.emplace(rampayer, [&](auto &s) {
             s.key            = swap_table.available_primary_key();
@@ -48,36 +40,142 @@ namespace eosio {
             s.swap_id        = swap_hash;
             s.swap_timestamp = swap_timestamp;
             s.status         = static_cast<int8_t>(swap_status::INITIALIZED);
-            s.provided_approvals.push_back(rampayer);
+            s.quantity.emplace(quantity);
+            s.approvals.emplace(swap_approvals{ producers.version, producer_bit, 1 });
          });
       } else {
-         const vector <name> &approvals = swap_hash_it->provided_approvals;
-         bool is_already_approved = std::find(approvals.begin(), approvals.end(), rampayer) == approvals.end();
+         add_approval(rampayer, *swap_hash_it, producers, quantity);
+      }
+      cleanup_swaps(swap_cleanup_depth);
+      swap_hash_it = swap_hash_idx.find(swap_data::get_swap_hash(swap_hash));
+
+      confirmation_info confirmation;
+      issue_if_confirmed(rampayer, *swap_hash_it, quantity, producers, confirmation);
+   }
 
-         check(is_already_approved, "approval already exists");
+   void swap::initbatch(const name &producer, const vector<swap_descriptor> &swaps)
+   {
+      require_auth(producer);
+      check(!swaps.empty(), "empty swaps list");
+      const producers_set &producers = get_producers_set(producer);
+      const uint64_t producer_bit = get_producer_bit(producers, producer);
+      check(producer_bit != 0, "only top25 block producers' approvals are recorded");
+
+      swap_params_data = swap_params_table.get();
+      const asset min_account_stake = get_min_account_stake();
+      confirmation_info confirmation = get_confirmation_info(producers);
+      auto swap_hash_idx = swap_table.get_index<"byhash"_n>();
+
+      vector<init_result> results;
+      results.reserve(swaps.size());
+      for (const auto &swap: swaps) {
+         init_result &result = results.emplace_back();
+         const char* init_error = get_init_error(swap.swap_pubkey, swap.quantity, swap.return_chain_id,
+                                                 swap.swap_timestamp, min_account_stake);
+         if (init_error) {
+            result.error = init_error;
+            continue;
+         }
 
-         if (swap_hash_it->status == static_cast<int8_t>(swap_status::INITIALIZED)) {
-            swap_table.modify(*swap_hash_it, rampayer, [&](auto &s) {
-               s.provided_approvals.push_back(rampayer);
+         result.swap_id = get_swap_id(
+            swap.txid, swap.swap_pubkey, swap.quantity, swap.return_address,
+            swap.return_chain_id, swap.swap_timestamp
+         );
+
+         auto swap_hash_it = swap_hash_idx.find(swap_data::get_swap_hash(result.swap_id));
+         if (swap_hash_it == swap_hash_idx.end()) {
+            const auto &created = swap_table.emplace(producer, [&](auto &s) {
+               s.key            = swap_table.available_primary_key();
+               s.txid           = swap.txid;
+               s.swap_id        = result.swap_id;
+               s.swap_timestamp = swap.swap_timestamp;
+               s.status         = static_cast<int8_t>(swap_status::INITIALIZED);
+               s.quantity.emplace(swap.quantity);
+               s.approvals.emplace(swap_approvals{ producers.version, producer_bit, 1 });
             });
+            issue_if_confirmed(producer, *created, swap.quantity, producers, confirmation);
+            continue;
+         }
+
+         uint64_t approvals_mask = 0;
+         if (!find_approvals_mask(*swap_hash_it, producers, approvals_mask)) {
+            result.error = "producers set doesn't exist";
+         } else if (approvals_mask & producer_bit) {
+            result.error = "approval already exists";
+         } else {
+            add_approval(producer, *swap_hash_it, producers, swap.quantity);
+            issue_if_confirmed(producer, *swap_hash_it, swap.quantity, producers, confirmation);
          }
       }
-      cleanup_swaps();
-      swap_hash_it = swap_hash_idx.find(swap_data::get_swap_hash(swap_hash));
-      bool is_status_init = swap_hash_it->status == static_cast<int8_t>(swap_status::INITIALIZED);
-      if (is_status_init && is_swap_confirmed(swap_hash_it->provided_approvals)) {
-         issue_tokens(rampayer, quantity);
-         swap_table.modify(*swap_hash_it, rampayer, [&](auto &s) {
-            s.status = static_cast<int8_t>(swap_status::ISSUED);
-         });
+      cleanup_swaps(swap_cleanup_depth);
+
+      batch_result_action batchresult(get_self(), {get_self(), system_contract::active_permission});
+      batchresult.send(producer, results);
+   }
+
+   void swap::batchresult(const name &producer, const vector<init_result> &results)
+   {
+      require_auth(get_self());
+   }
+
+   void swap::cleanup(const uint64_t &max_rows)
+   {
+      check(max_rows > 0, "max_rows must be positive");
+      cleanup_swaps(max_rows);
+   }
+
+   void swap::migrateswaps(const uint64_t &max_rows)
+   {
+      require_auth(get_self());
+      check(max_rows > 0, "max_rows must be positive");
+
+      // swaps created before the expiration index have the lowest keys, a reindexed swap gets a new key
+      uint64_t i = 0;
+      for (auto it = swap_table.begin(); it != swap_table.end() && i < max_rows; ++i) {
+         if (has_expiry_entry(*it)) {
+            break;
+         }
+         if (!is_expired(*it)) {
+            const swap_data swap = *it;
+            swap_table.emplace(get_self(), [&](auto &s) {
+               s = swap;
+               s.key = swap_table.available_primary_key();
+            });
+         }
+         it = swap_table.erase(it);
       }
    }
 
+   void swap::approve(const name &producer, const checksum256 &swap_id)
+   {
+      require_auth(producer);
+      const producers_set &producers = get_producers_set(producer);
+      check(get_producer_bit(producers, producer) != 0, "only top25 block producers' approvals are recorded");
+
+      auto swap_hash_idx = swap_table.get_index<"byhash"_n>();
+      auto swap_hash_it = swap_hash_idx.find(swap_data::get_swap_hash(swap_id));
+      check(swap_hash_it != swap_hash_idx.end(), "swap doesn't exist");
+      // swaps initialized before the quantity was stored get it with the next init action
+      check(swap_hash_it->quantity.has_value(), "swap has to be approved with init action");
+      const asset &quantity = swap_hash_it->quantity.value();
+      check(quantity.is_valid() && quantity.amount > 0, "invalid quantity");
+
+      time_point swap_timepoint = swap_hash_it->swap_timestamp.to_time_point();
+      auto swap_expiration_delta = current_time_point().time_since_epoch() - swap_lifetime.time_since_epoch();
+      check(time_point(swap_expiration_delta) < swap_timepoint, "swap lifetime expired");
+
+      add_approval(producer, *swap_hash_it, producers, quantity);
+
+      confirmation_info confirmation;
+      issue_if_confirmed(producer, *swap_hash_it, quantity, producers, confirmation);
+   }
+
    void swap::finish(const name &rampayer, const name &receiver, const string &txid, const string &swap_pubkey_str,
                      asset &quantity, const string &return_address, const string &return_chain_id,
                      const block_timestamp &swap_timestamp, const signature &sign)
    {
       require_auth(rampayer);
+      swap_params_data = swap_params_table.get();
 
       const checksum256 swap_hash = get_swap_id(
          txid, swap_pubkey_str, quantity, return_address,
@@ -115,6 +213,7 @@ namespace eosio {
                            const block_timestamp &swap_timestamp, const signature &sign)
    {
       require_auth(rampayer);
+      swap_params_data = swap_params_table.get();
 
       const checksum256 swap_hash = get_swap_id(
          txid, swap_pubkey_str, quantity, return_address,
@@ -161,6 +260,7 @@ namespace eosio {
                      const block_timestamp &swap_timestamp)
    {
       require_auth(rampayer);
+      swap_params_data = swap_params_table.get();
       time_point swap_timepoint = swap_timestamp.to_time_point();
 
       const checksum256 swap_hash = get_swap_id(
@@ -194,8 +294,7 @@ namespace eosio {
       check(!chain_id.empty(), "empty chain id");
       check(!eth_return_chainid.empty(), "empty ethereum return chain id");
 
-      utils::validate_address_action validate_address(system_contract::utils_account, {get_self(), system_contract::active_permission});
-      validate_address.send(name(eth_return_chainid), eth_swap_contract_address);
+      validate_address(name(eth_return_chainid), eth_swap_contract_address);
 
       swap_params_data.chain_id                   = chain_id;
       swap_params_data.eth_swap_contract_address  = eth_swap_contract_address;
@@ -233,33 +332,41 @@ namespace eosio {
 
    checksum256 swap::get_swap_id(const string &txid, const string &swap_pubkey_str, const asset &quantity,
                                  const string &return_address, const string &return_chain_id,
-                                 const block_timestamp &swap_timestamp)
+                                 const block_timestamp &swap_timestamp) const
    {
       time_point swap_timepoint = swap_timestamp.to_time_point();
-      swap_params_data = swap_params_table.get();
 
-      string swap_payload = join({swap_pubkey_str.substr(3), txid, swap_params_data.chain_id, quantity.to_string(),
-                                  return_address, return_chain_id, std::to_string(swap_timepoint.sec_since_epoch())});
+      payload_builder<max_payload_size> swap_payload;
+      swap_payload.add(std::string_view(swap_pubkey_str).substr(3))
+                  .add(txid)
+                  .add(swap_params_data.chain_id)
+                  .add(quantity)
+                  .add(return_address)
+                  .add(return_chain_id)
+                  .add(swap_timepoint.sec_since_epoch());
 
-      checksum256 swap_hash = sha256(swap_payload.c_str(), swap_payload.size());
-      return swap_hash;
+      return swap_payload.hash();
    }
 
    checksum256 swap::get_digest_msg(const name &receiver, const string &owner_key, const string &active_key,
                                     const string &txid, const asset &quantity, const string &return_address,
-                                    const string &return_chain_id, const block_timestamp &swap_timestamp)
+                                    const string &return_chain_id, const block_timestamp &swap_timestamp) const
    {
       time_point swap_timepoint = swap_timestamp.to_time_point();
-      swap_params_data = swap_params_table.get();
-
-      string payload = join({txid, swap_params_data.chain_id, quantity.to_string(), return_address,
-                             return_chain_id, std::to_string(swap_timepoint.sec_since_epoch())});
-
-      string sign_payload = (owner_key.size() == 0) ? join({receiver.to_string(), payload}) :
-                            join({receiver.to_string(), owner_key, active_key, payload});
 
-      checksum256 digest = sha256(sign_payload.c_str(), sign_payload.size());
-      return digest;
+      payload_builder<max_payload_size> sign_payload;
+      sign_payload.add(receiver);
+      if (owner_key.size() != 0) {
+         sign_payload.add(owner_key).add(active_key);
+      }
+      sign_payload.add(txid)
+                  .add(swap_params_data.chain_id)
+                  .add(quantity)
+                  .add(return_address)
+                  .add(return_chain_id)
+                  .add(swap_timepoint.sec_since_epoch());
+
+      return sign_payload.hash();
    }
 
    void swap::validate_pubkey(const signature &sign, const checksum256 &digest, const string &swap_pubkey_str) const
@@ -268,6 +375,85 @@ namespace eosio {
       assert_recover_key(digest, sign, swap_pubkey);
    }
 
+   const char* swap::get_init_error(const string &swap_pubkey, const asset &quantity, const string &return_chain_id,
+                                    const block_timestamp &swap_timestamp, const asset &min_account_stake) const
+   {
+      if (!is_valid_chain_id(return_chain_id)) {
+         return "invalid chain id";
+      }
+      auto chain_it = chains_table.find(name(return_chain_id).value);
+      if (chain_it == chains_table.end() || !chain_it->input) {
+         return "not supported chain id";
+      }
+      if (!is_valid_pubkey_prefix(swap_pubkey)) {
+         return "invalid type of public key";
+      }
+      if (!quantity.is_valid()) {
+         return "invalid quantity";
+      }
+      if (quantity.symbol != min_account_stake.symbol) {
+         return "symbol precision mismatch";
+      }
+      if (quantity.amount < min_account_stake.amount + chain_it->in_swap_min_amount) {
+         return "the quantity must be greater than the swap fee";
+      }
+
+      time_point swap_timepoint = swap_timestamp.to_time_point();
+      auto swap_expiration_delta = current_time_point().time_since_epoch() - swap_lifetime.time_since_epoch();
+      if (time_point(swap_expiration_delta) >= swap_timepoint) {
+         return "swap lifetime expired";
+      }
+      if (current_time_point() <= swap_timepoint) {
+         return "swap cannot be initialized with a future timestamp";
+      }
+      return nullptr;
+   }
+
+   void swap::add_approval(const name &producer, const swap_data &swap, const producers_set &set,
+                           const asset &quantity)
+   {
+      // the mask is remapped to `set`, approvals of the producers which are not in `set` are discarded
+      const uint64_t producer_bit = get_producer_bit(set, producer);
+      const uint64_t approvals_mask = get_approvals_mask(swap, set);
+      check(!(approvals_mask & producer_bit), "approval already exists");
+
+      if (swap.status == static_cast<int8_t>(swap_status::INITIALIZED)) {
+         const uint64_t mask = approvals_mask | producer_bit;
+         swap_table.modify(swap, producer, [&](auto &s) {
+            s.provided_approvals.clear();
+            // the approvals extension follows the quantity one, a legacy row would get a default asset otherwise
+            if (!s.quantity.has_value()) {
+               s.quantity.emplace(quantity);
+            }
+            s.approvals.emplace(swap_approvals{ set.version, mask, static_cast<uint8_t>(__builtin_popcountll(mask)) });
+         });
+      }
+   }
+
+   void swap::issue_if_confirmed(const name &rampayer, const swap_data &swap, const asset &quantity,
+                                 const producers_set &set, confirmation_info &confirmation)
+   {
+      if (swap.status != static_cast<int8_t>(swap_status::INITIALIZED)) {
+         return;
+      }
+      if (confirmation.majority == 0) {
+         confirmation = get_confirmation_info(set);
+      }
+
+      // approvals of the initialized swap are always mapped to the current producers set
+      const swap_approvals &approvals = swap.approvals.value();
+      if (approvals.count < confirmation.majority) {
+         return;
+      }
+      const uint8_t active_approvals = __builtin_popcountll(approvals.mask & confirmation.active_mask);
+      if (active_approvals >= confirmation.majority) {
+         issue_tokens(rampayer, quantity);
+         swap_table.modify(swap, rampayer, [&](auto &s) {
+            s.status = static_cast<int8_t>(swap_status::ISSUED);
+         });
+      }
+   }
+
    void swap::is_ready_to_finish(const checksum256 &swap_hash) const
    {
       auto swap_hash_idx = swap_table.get_index<"byhash"_n>();
@@ -284,21 +470,32 @@ namespace eosio {
       check(swap_hash_it->status == static_cast<int8_t>(swap_status::ISSUED), "not enough active producers approvals");
    }
 
-   void swap::cleanup_swaps()
+   bool swap::is_expired(const swap_data &swap) const
    {
-      const uint8_t max_clear_depth = 10;
-      size_t i = 0;
-      for (auto _table_it = swap_table.begin(); _table_it != swap_table.end();) {
-         time_point swap_timepoint = _table_it->swap_timestamp.to_time_point();
-         bool not_expired = time_point_sec(current_time_point()) <= swap_timepoint + swap_lifetime;
+      return time_point_sec(current_time_point()) > swap.swap_timestamp.to_time_point() + swap_lifetime;
+   }
 
-         if (not_expired || i >= max_clear_depth) {
-            break;
-         } else {
-            _table_it = swap_table.erase(_table_it);
-            ++i;
+   size_t swap::cleanup_swaps(size_t max_rows)
+   {
+      size_t erased = 0;
+      auto expiry_idx = swap_table.get_index<"byexpiry"_n>();
+      auto expiry_it = expiry_idx.begin();
+      while (expiry_it != expiry_idx.end() && erased < max_rows && is_expired(*expiry_it)) {
+         expiry_it = expiry_idx.erase(expiry_it);
+         ++erased;
+      }
+      return erased;
+   }
+
+   bool swap::has_expiry_entry(const swap_data &swap) const
+   {
+      auto expiry_idx = swap_table.get_index<"byexpiry"_n>();
+      for (auto it = expiry_idx.lower_bound(swap.by_expiry()); it != expiry_idx.end() && it->by_expiry() == swap.by_expiry(); ++it) {
+         if (it->key == swap.key) {
+            return true;
          }
       }
+      return false;
    }
 
    void swap::ontransfer(name from, name to, asset quantity, string memo)
@@ -315,8 +512,7 @@ namespace eosio {
       string return_address = memo.substr(space_pos + 1);
       check(return_address.size() > 0, "invalid address");
 
-      utils::validate_address_action validate_address(system_contract::utils_account, {get_self(), system_contract::active_permission});
-      validate_address.send(name(return_chain_id), return_address);
+      validate_address(name(return_chain_id), return_address);
 
       auto chain_it = chains_table.find(name(return_chain_id).value);
       check(quantity.symbol == system_contract::get_core_symbol(), "symbol precision mismatch");
@@ -328,6 +524,16 @@ namespace eosio {
       require_recipient(get_self());
    }
 
+   void swap::ontransfermany(name from, const vector<std::pair<name, asset>> &transfers, string memo)
+   {
+      if (from == get_self()) {
+         return;
+      }
+      for (const auto &[to, quantity] : transfers) {
+         check(to != get_self(), "use transfer with the swap memo to send tokens to the swap contract");
+      }
+   }
+
    void swap::transfer(const name &receiver, const asset &quantity, const string &memo)
    {
       token::transfer_action transfer(system_contract::token_account, {get_self(), system_contract::active_permission});
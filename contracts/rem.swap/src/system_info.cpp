@@ -5,6 +5,8 @@
 #include <rem.swap/rem.swap.hpp>
 #include <rem.system/rem.system.hpp>
 
+#include <algorithm>
+
 namespace eosio {
 
    using eosiosystem::system_contract;
@@ -75,31 +77,115 @@ namespace eosio {
       return _producers;
    }
 
-   bool swap::is_block_producer( const name& user ) const
+   const swap::producers_set& swap::get_producers_set( const name& rampayer )
+   {
+      // the set is kept sorted, so a reordering of the schedule or the standby list is not a new version
+      vector<name> producers = get_producers();
+      std::sort( producers.begin(), producers.end() );
+      producers.erase( std::unique( producers.begin(), producers.end() ), producers.end() );
+
+      auto last_set_it = producers_sets_table.rbegin();
+      if ( last_set_it != producers_sets_table.rend() && last_set_it->producers == producers ) {
+         return *last_set_it;
+      }
+      check( producers.size() <= max_set_producers, "too many block producers for the approvals mask" );
+
+      const time_point ct = current_time_point();
+      uint64_t version = 0;
+      if ( last_set_it != producers_sets_table.rend() ) {
+         version = last_set_it->version + 1;
+         producers_sets_table.modify(*last_set_it, same_payer, [&](auto &p) {
+            p.superseded_at = ct;
+         });
+      }
+
+      // approvals of a swap are remapped on each approval, so a set superseded more than
+      // swap lifetime ago can be referenced only by expired swaps
+      for ( auto it = producers_sets_table.begin(); it != producers_sets_table.end(); ) {
+         bool is_referenced = it->superseded_at == time_point() ||
+                              ct <= it->superseded_at + swap_lifetime.time_since_epoch();
+         if ( is_referenced ) {
+            break;
+         }
+         it = producers_sets_table.erase(it);
+      }
+
+      return *producers_sets_table.emplace(rampayer, [&](auto &p) {
+         p.version   = version;
+         p.producers = producers;
+      });
+   }
+
+   uint64_t swap::get_producer_bit( const producers_set& set, const name& producer ) const
    {
-      vector<name> _producers = get_producers();
-      return std::find(_producers.begin(), _producers.end(), user) != _producers.end();
+      auto it = std::find(set.producers.begin(), set.producers.end(), producer);
+      return it == set.producers.end() ? 0 : uint64_t(1) << (it - set.producers.begin());
    }
 
-   bool swap::is_swap_confirmed( const vector<name>& provided_approvals ) const
+   uint64_t swap::get_approvals_mask( const swap_data& swap, const producers_set& set ) const
    {
-      vector<name> _producers = eosio::get_active_producers();
-      uint8_t quantity_active_appr = 0;
-      for (const auto& producer: provided_approvals) {
-         auto prod_appr = std::find(_producers.begin(), _producers.end(), producer);
-         if ( prod_appr != _producers.end() || producer == system_account ) {
-            ++quantity_active_appr;
+      uint64_t mask = 0;
+      check( find_approvals_mask(swap, set, mask), "producers set doesn't exist" );
+      return mask;
+   }
+
+   bool swap::find_approvals_mask( const swap_data& swap, const producers_set& set, uint64_t& mask ) const
+   {
+      mask = 0;
+      if ( !swap.approvals.has_value() ) {
+         for (const auto& producer: swap.provided_approvals) {
+            mask |= get_producer_bit(set, producer);
+         }
+         return true;
+      }
+
+      const swap_approvals& approvals = swap.approvals.value();
+      if ( approvals.producers_version == set.version ) {
+         mask = approvals.mask;
+         return true;
+      }
+      const auto approvals_set_it = producers_sets_table.find(approvals.producers_version);
+      if ( approvals_set_it == producers_sets_table.end() ) {
+         return false;
+      }
+      for (size_t i = 0; i < approvals_set_it->producers.size(); ++i) {
+         if ( approvals.mask & (uint64_t(1) << i) ) {
+            mask |= get_producer_bit(set, approvals_set_it->producers[i]);
          }
       }
-      const uint8_t majority = (_producers.size() * 2 / 3) + 1;
-      if ( majority <= quantity_active_appr ) { return true; }
-      return false;
+      return true;
+   }
+
+   swap::confirmation_info swap::get_confirmation_info( const producers_set& set ) const
+   {
+      const vector<name> _producers = eosio::get_active_producers();
+      confirmation_info confirmation;
+      confirmation.majority = (_producers.size() * 2 / 3) + 1;
+      for (const auto& producer: _producers) {
+         confirmation.active_mask |= get_producer_bit(set, producer);
+      }
+      confirmation.active_mask |= get_producer_bit(set, system_account);
+      return confirmation;
+   }
+
+   bool swap::is_valid_pubkey_prefix(const string& pubkey_str) const
+   {
+      std::string_view pubkey_pre = std::string_view(pubkey_str).substr(0, 3);
+      return pubkey_pre == "EOS" || pubkey_pre == "REM";
    }
 
-   void swap::check_pubkey_prefix(const string& pubkey_str) const
+   bool swap::is_valid_chain_id(const string& chain_id) const
    {
-      string pubkey_pre = pubkey_str.substr(0, 3);
-      check(pubkey_pre == "EOS" || pubkey_pre == "REM", "invalid type of public key");
+      if (chain_id.empty() || chain_id.size() > 12) {
+         return false;
+      }
+      for (const char ch: chain_id) {
+         bool is_valid_char = (ch >= 'a' && ch <= 'z') || (ch >= '1' && ch <= '5') || ch == '.';
+         if (!is_valid_char) {
+            return false;
+         }
+      }
+      return true;
    }
 
 } // namespace eosio
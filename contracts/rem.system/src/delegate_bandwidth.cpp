@@ -66,11 +66,8 @@ namespace eosiosystem {
          from = receiver;
       }
 
-      int64_t discount = 0;
-      if ( eosio::attribute::has_attribute( _gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, source_stake_from, _gremstate.gifter_attr_name ) ) {
-         discount = eosio::attribute::get_attribute<int64_t>(_gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, source_stake_from, _gremstate.gifter_attr_name);
-         check( (discount >= 0) && (discount <= 100'0000), "discount value should be in range[0, 100'0000]" );
-      }
+      const int64_t discount = eosio::attribute::find_attribute<int64_t>( _gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, source_stake_from, _gremstate.gifter_attr_name ).value_or(0);
+      check( (discount >= 0) && (discount <= 100'0000), "discount value should be in range[0, 100'0000]" );
       const int64_t delta2min_account_stake = ( _gstate.min_account_stake - min_threshold_stake ) * ( 1 - (discount / 100'0000.0) );
 
       // update stake delegated from "from" to "receiver"
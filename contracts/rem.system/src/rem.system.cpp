@@ -332,8 +332,9 @@ namespace eosiosystem {
       int64_t free_stake_amount = 0;
       int64_t free_gift_bytes   = 0;
 
-      if ( eosio::attribute::has_attribute( _gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, creator, _gremstate.gifter_attr_name ) ) {
-         const auto discount = eosio::attribute::get_attribute< int64_t >( _gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, creator, _gremstate.gifter_attr_name );
+      const auto gifter_discount = eosio::attribute::find_attribute< int64_t >( _gremstate.gifter_attr_contract, _gremstate.gifter_attr_issuer, creator, _gremstate.gifter_attr_name );
+      if ( gifter_discount ) {
+         const auto discount = *gifter_discount;
          // discount attribute is set as percent with precision of 4 symbols
          // 0 - 0.0000%, 100'0000 - 100.0000%
          check( (discount >= 0) && (discount <= 100'0000), "discount value should be in range[0, 100'0000]" );
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
+#include <eosio/time.hpp>
 
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace eosiosystem {
    class system_contract;
@@ -12,6 +16,7 @@ namespace eosiosystem {
 namespace eosio {
 
    using std::string;
+   using std::vector;
 
    /**
     * @defgroup eosiotoken rem.token
@@ -84,6 +89,24 @@ namespace eosio {
                         const name&    to,
                         const asset&   quantity,
                         const string&  memo );
+
+         /**
+          * Transfer many action.
+          *
+          * @details Allows `from` account to transfer tokens of one symbol to several accounts in one action.
+          * `from` is debited once with the sum of the quantities and every receiver is credited and notified.
+          * Receivers are notified with the transfermany action, not with transfer, so a receiver contract that
+          * handles only transfer notifications doesn't see the tokens credited to it and must reject transfermany
+          * to avoid keeping them, as rem.swap does.
+          *
+          * @param from - the account to transfer from,
+          * @param transfers - the accounts to be transferred to with the quantities of tokens to be transferred,
+          * @param memo - the memo string to accompany the transaction.
+          */
+         [[eosio::action]]
+         void transfermany( const name&                           from,
+                            const vector<std::pair<name, asset>>& transfers,
+                            const string&                         memo );
          /**
           * Open action.
           *
@@ -115,6 +138,26 @@ namespace eosio {
          [[eosio::action]]
          void close( const name& owner, const symbol& symbol );
 
+         /**
+          * Set checkpoint period action.
+          *
+          * @details Allows the issuer of token `sym_code` to turn on balance checkpoints or to change their period.
+          * Every later balance change of the token is recorded in the checkpoints table of the account, at most
+          * one checkpoint per account and per `period` seconds holds the last balance of the period. The first
+          * checkpoint of an account also records the balance it held when the checkpoints were turned on.
+          * Checkpoints can't be turned off, a gap in them would make get_balance_at return a stale balance.
+          *
+          * Checkpoints are not pruned. The checkpoint of the sender is billed to the sender and the checkpoint of
+          * a receiver to the payer of the transfer, the receiver itself only if it authorized the transfer,
+          * so each transfer to an account without a checkpoint in the current period costs the sender the RAM
+          * of one checkpoint row (two for the first checkpoint of the account) in the scope of the receiver.
+          *
+          * @param sym_code - the token to set the checkpoint period for,
+          * @param period - the checkpoint period in seconds, must be positive.
+          */
+         [[eosio::action]]
+         void setcheckpt( const symbol_code& sym_code, const uint32_t& period );
+
          /**
           * Get supply method.
           *
@@ -162,12 +205,62 @@ namespace eosio {
             return ac.balance;
          }
 
+         /**
+          * Get balance at time method.
+          *
+          * @details Get the balance for a token `sym_code` created by `token_contract_account` account,
+          * for account `owner` from the last checkpoint recorded at or before `time`, or the current balance
+          * if it hasn't changed since the checkpoints were turned on. A checkpoint holds the balance at the end
+          * of its period and the time of the first change in the period, so the result is exact at period
+          * boundaries, inside a period with changes it is the balance at the end of that period.
+          *
+          * @param token_contract_account - the token creator account,
+          * @param owner - the account for which the token balance is returned,
+          * @param sym_code - the token for which the balance is returned,
+          * @param time - the time of the balance.
+          *
+          * @return the balance, or nothing for a time before the checkpoints were turned on or an account
+          * without a balance of the token.
+          */
+         static std::optional<asset> get_balance_at( const name& token_contract_account, const name& owner,
+                                                     const symbol_code& sym_code, const block_timestamp& time )
+         {
+            checkpoints checkpoints_table( token_contract_account, owner.value );
+            const auto checkpoint_idx = checkpoints_table.get_index<"bysymtime"_n>();
+            const auto next = checkpoint_idx.upper_bound( checkpoint::get_symbol_time( sym_code, time ) );
+            if( next != checkpoint_idx.begin() ) {
+               auto last = next;
+               if( (--last)->balance.symbol.code() == sym_code ) {
+                  return last->balance;
+               }
+            }
+            // the first checkpoint of an account holds the balance from the time the checkpoints were turned on
+            if( next != checkpoint_idx.end() && next->balance.symbol.code() == sym_code ) {
+               return std::nullopt;
+            }
+
+            // the balance hasn't changed since the checkpoints were turned on
+            stats statstable( token_contract_account, sym_code.raw() );
+            const auto st = statstable.find( sym_code.raw() );
+            if( st == statstable.end() || st->get_checkpoint_start().slot == 0 || time.slot < st->get_checkpoint_start().slot ) {
+               return std::nullopt;
+            }
+            accounts accountstable( token_contract_account, owner.value );
+            const auto ac = accountstable.find( sym_code.raw() );
+            if( ac == accountstable.end() ) {
+               return std::nullopt;
+            }
+            return ac->balance;
+         }
+
          using create_action = eosio::action_wrapper<"create"_n, &token::create>;
          using issue_action = eosio::action_wrapper<"issue"_n, &token::issue>;
          using retire_action = eosio::action_wrapper<"retire"_n, &token::retire>;
          using transfer_action = eosio::action_wrapper<"transfer"_n, &token::transfer>;
+         using transfermany_action = eosio::action_wrapper<"transfermany"_n, &token::transfermany>;
          using open_action = eosio::action_wrapper<"open"_n, &token::open>;
          using close_action = eosio::action_wrapper<"close"_n, &token::close>;
+         using setcheckpt_action = eosio::action_wrapper<"setcheckpt"_n, &token::setcheckpt>;
       private:
          struct [[eosio::table]] account {
             asset    balance;
@@ -179,15 +272,42 @@ namespace eosio {
             asset    supply;
             asset    max_supply;
             name     issuer;
+            binary_extension<uint32_t> checkpoint_period;
+            binary_extension<block_timestamp> checkpoint_start; // time the checkpoints were turned on
 
             uint64_t primary_key()const { return supply.symbol.code().raw(); }
+            uint32_t get_checkpoint_period()const { return checkpoint_period.value_or(0); }
+            // zero until the checkpoints are turned on, a modified row stores the default of a missing extension
+            block_timestamp get_checkpoint_start()const {
+               return get_checkpoint_period() != 0 ? checkpoint_start.value_or( block_timestamp() ) : block_timestamp();
+            }
+         };
+
+         // balance of the account after the last change in a checkpoint period, scoped by the account
+         struct [[eosio::table]] checkpoint {
+            uint64_t          id;
+            block_timestamp   time;
+            asset             balance;
+
+            // symbol in the high word so checkpoints of one token are adjacent and ordered by time
+            static uint128_t get_symbol_time( const symbol_code& sym_code, const block_timestamp& time ) {
+               return (uint128_t{sym_code.raw()} << 64) | time.slot;
+            }
+
+            uint64_t primary_key()const { return id; }
+            uint128_t by_symbol_time()const { return get_symbol_time( balance.symbol.code(), time ); }
          };
 
          typedef eosio::multi_index< "accounts"_n, account > accounts;
          typedef eosio::multi_index< "stat"_n, currency_stats > stats;
+         typedef eosio::multi_index< "checkpoints"_n, checkpoint,
+                                     indexed_by<"bysymtime"_n, const_mem_fun<checkpoint, uint128_t, &checkpoint::by_symbol_time>>
+                                   > checkpoints;
 
-         void sub_balance( const name& owner, const asset& value );
-         void add_balance( const name& owner, const asset& value, const name& ram_payer );
+         void sub_balance( const name& owner, const asset& value, const currency_stats& st );
+         void add_balance( const name& owner, const asset& value, const name& ram_payer, const currency_stats& st );
+         void add_checkpoint( const name& owner, const asset& balance, const asset& previous_balance, const name& ram_payer,
+                              const currency_stats& st );
    };
    /** @}*/ // end of @defgroup eosiotoken rem.token
 } /// namespace eosio
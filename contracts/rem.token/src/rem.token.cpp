@@ -1,4 +1,7 @@
 #include <rem.token/rem.token.hpp>
+#include <rem.utils/check.hpp>
+
+#include <eosio/system.hpp>
 
 
 namespace eosio {
@@ -49,7 +52,7 @@ void token::issue( const name& to, const asset& quantity, const string& memo )
        s.supply += quantity;
     });
 
-    add_balance( st.issuer, quantity, st.issuer );
+    add_balance( st.issuer, quantity, st.issuer, st );
 }
 
 void token::retire( const asset& quantity, const string& memo )
@@ -73,7 +76,7 @@ void token::retire( const asset& quantity, const string& memo )
        s.supply -= quantity;
     });
 
-    sub_balance( st.issuer, quantity );
+    sub_balance( st.issuer, quantity, st );
 }
 
 void token::transfer( const name&    from,
@@ -98,28 +101,61 @@ void token::transfer( const name&    from,
 
     auto payer = has_auth( to ) ? to : from;
 
-    sub_balance( from, quantity );
-    add_balance( to, quantity, payer );
+    sub_balance( from, quantity, st );
+    add_balance( to, quantity, payer, st );
+}
+
+void token::transfermany( const name&                           from,
+                          const vector<std::pair<name, asset>>& transfers,
+                          const string&                         memo )
+{
+    require_auth( from );
+    check( !transfers.empty(), "empty transfers list" );
+    auto sym = transfers.front().second.symbol.code();
+    stats statstable( get_self(), sym.raw() );
+    const auto& st = statstable.get( sym.raw() );
+
+    require_recipient( from );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+    asset total( 0, st.supply.symbol );
+    for( const auto& [to, quantity] : transfers ) {
+        check( from != to, "cannot transfer to self" );
+        check( is_account( to ), "to account does not exist");
+        check( quantity.is_valid(), "invalid quantity" );
+        check( quantity.amount > 0, "must transfer positive quantity" );
+        check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+        require_recipient( to );
+        total += quantity;
+    }
+
+    sub_balance( from, total, st );
+    for( const auto& [to, quantity] : transfers ) {
+        add_balance( to, quantity, has_auth( to ) ? to : from, st );
+    }
 }
 
-void token::sub_balance( const name& owner, const asset& value ) {
+void token::sub_balance( const name& owner, const asset& value, const currency_stats& st ) {
    accounts from_acnts( get_self(), owner.value );
 
-   const std::string err_str = "no balance object found for: "s + owner.to_string() + "; symbol: "s + value.symbol.code().to_string();
-   const auto& from = from_acnts.get( value.symbol.code().raw(), err_str.c_str() );
-   check( from.balance.amount >= value.amount, "overdrawn balance" );
+   const auto from = from_acnts.find( value.symbol.code().raw() );
+   check( from != from_acnts.end(), [&]() {
+      return "no balance object found for: "s + owner.to_string() + "; symbol: "s + value.symbol.code().to_string();
+   });
+   check( from->balance.amount >= value.amount, "overdrawn balance" );
 
    from_acnts.modify( from, owner, [&]( auto& a ) {
          a.balance -= value;
       });
+   add_checkpoint( owner, from->balance, from->balance + value, owner, st );
 }
 
-void token::add_balance( const name& owner, const asset& value, const name& ram_payer )
+void token::add_balance( const name& owner, const asset& value, const name& ram_payer, const currency_stats& st )
 {
    accounts to_acnts( get_self(), owner.value );
    auto to = to_acnts.find( value.symbol.code().raw() );
    if( to == to_acnts.end() ) {
-      to_acnts.emplace( ram_payer, [&]( auto& a ){
+      to = to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
    } else {
@@ -127,6 +163,66 @@ void token::add_balance( const name& owner, const asset& value, const name& ram_
         a.balance += value;
       });
    }
+   add_checkpoint( owner, to->balance, to->balance - value, ram_payer, st );
+}
+
+void token::add_checkpoint( const name& owner, const asset& balance, const asset& previous_balance, const name& ram_payer,
+                            const currency_stats& st )
+{
+   const uint32_t checkpoint_period = st.get_checkpoint_period();
+   if( checkpoint_period == 0 ) {
+      return;
+   }
+
+   checkpoints checkpoints_table( get_self(), owner.value );
+   auto checkpoint_idx = checkpoints_table.get_index<"bysymtime"_n>();
+   const block_timestamp ct = current_block_time();
+   auto last = checkpoint_idx.upper_bound( checkpoint::get_symbol_time( balance.symbol.code(), ct ) );
+   bool has_checkpoint = false;
+   if( last != checkpoint_idx.begin() ) {
+      --last;
+      has_checkpoint = last->balance.symbol == balance.symbol;
+      const bool is_same_period = last->time.to_time_point().sec_since_epoch() / checkpoint_period ==
+                                  ct.to_time_point().sec_since_epoch() / checkpoint_period;
+      if( has_checkpoint && is_same_period ) {
+         // the checkpoint keeps the time of the first change in the period
+         checkpoint_idx.modify( last, same_payer, [&]( auto& c ) {
+            c.balance = balance;
+         });
+         return;
+      }
+   }
+
+   // the first checkpoint of the account also records the balance held since the checkpoints were turned on
+   if( !has_checkpoint && st.get_checkpoint_start().slot != 0 ) {
+      checkpoints_table.emplace( ram_payer, [&]( auto& c ) {
+         c.id      = checkpoints_table.available_primary_key();
+         c.time    = st.get_checkpoint_start();
+         c.balance = previous_balance;
+      });
+   }
+   checkpoints_table.emplace( ram_payer, [&]( auto& c ) {
+      c.id      = checkpoints_table.available_primary_key();
+      c.time    = ct;
+      c.balance = balance;
+   });
+}
+
+void token::setcheckpt( const symbol_code& sym_code, const uint32_t& period )
+{
+   stats statstable( get_self(), sym_code.raw() );
+   const auto& st = statstable.get( sym_code.raw(), "token with symbol does not exist" );
+   require_auth( st.issuer );
+   check( period > 0, "checkpoint period must be positive, checkpoints can't be turned off" );
+
+   // balances of accounts without a checkpoint are known from the time the checkpoints are turned on
+   const bool is_started = st.get_checkpoint_period() != 0 && st.get_checkpoint_start().slot != 0;
+   statstable.modify( st, same_payer, [&]( auto& s ) {
+      s.checkpoint_period.emplace( period );
+      if( !is_started ) {
+         s.checkpoint_start.emplace( current_block_time() );
+      }
+   });
 }
 
 void token::open( const name& owner, const symbol& symbol, const name& ram_payer )
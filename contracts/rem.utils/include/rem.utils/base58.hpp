@@ -0,0 +1,105 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace eosio { namespace base58 {
+
+   /**
+    * The base-58 alphabet used by EOSIO keys and signatures.
+    */
+   constexpr char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+   /**
+    * Build the character to digit decode table, -1 marks characters outside of the alphabet.
+    */
+   constexpr std::array<int8_t, 256> make_decode_map() {
+      std::array<int8_t, 256> map{};
+      for (size_t i = 0; i < map.size(); ++i)
+         map[i] = -1;
+      for (size_t i = 0; i < sizeof(alphabet) - 1; ++i)
+         map[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+      return map;
+   }
+
+   inline constexpr std::array<int8_t, 256> decode_map = make_decode_map();
+
+   enum class decode_status : uint8_t {
+      ok = 0,
+      invalid_digit,
+      out_of_range
+   };
+
+   namespace detail {
+      // 58^5 is the largest power of 58 which fits in a 32-bit limb, so up to 5 digits are folded per pass
+      constexpr uint32_t digits_per_limb = 5;
+      constexpr uint32_t pow58[digits_per_limb + 1] = { 1, 58, 58 * 58, 58 * 58 * 58, 58 * 58 * 58 * 58,
+                                                        58u * 58 * 58 * 58 * 58 };
+
+      template <size_t Size>
+      constexpr size_t limbs_count = (Size + 3) / 4;
+
+      // multiply the little-endian number by `mul` and add `add`, returns false on overflow of `Size` bytes
+      template <size_t Size>
+      constexpr bool mul_add(std::array<uint32_t, limbs_count<Size>> &limbs, uint32_t mul, uint32_t add) {
+         uint64_t carry = add;
+         for (auto &limb : limbs) {
+            const uint64_t x = uint64_t(limb) * mul + carry;
+            limb = static_cast<uint32_t>(x);
+            carry = x >> 32;
+         }
+         if (carry)
+            return false;
+         if constexpr (Size % 4 != 0) {
+            return (limbs.back() >> (8 * (Size % 4))) == 0;
+         }
+         return true;
+      }
+   } // namespace detail
+
+   /**
+    * Decode base-58 string `s` into the big-endian number `result` of `Size` bytes.
+    *
+    * @details Leading '1' digits decode to leading zero bytes. Digits are folded into 32-bit limbs
+    * five at a time, the result is identical to the per-digit byte-wise decoding.
+    *
+    * @return decode_status::invalid_digit if `s` contains a character outside of the alphabet,
+    * decode_status::out_of_range if the value doesn't fit in `Size` bytes. When both apply the error met
+    * first while reading `s` from left to right is reported.
+    */
+   template <size_t Size>
+   constexpr decode_status decode(std::string_view s, std::array<uint8_t, Size> &result) {
+      std::array<uint32_t, detail::limbs_count<Size>> limbs{};
+
+      uint32_t group = 0;
+      uint32_t group_size = 0;
+      for (const char c : s) {
+         const int8_t digit = decode_map[static_cast<uint8_t>(c)];
+         if (digit < 0) {
+            if (!detail::mul_add<Size>(limbs, detail::pow58[group_size], group))
+               return decode_status::out_of_range;
+            return decode_status::invalid_digit;
+         }
+         group = group * 58 + static_cast<uint32_t>(digit);
+         if (++group_size == detail::digits_per_limb) {
+            if (!detail::mul_add<Size>(limbs, detail::pow58[group_size], group))
+               return decode_status::out_of_range;
+            group = 0;
+            group_size = 0;
+         }
+      }
+      if (group_size && !detail::mul_add<Size>(limbs, detail::pow58[group_size], group))
+         return decode_status::out_of_range;
+
+      for (size_t i = 0; i < Size; ++i)
+         result[Size - 1 - i] = static_cast<uint8_t>(limbs[i / 4] >> (8 * (i % 4)));
+      return decode_status::ok;
+   }
+
+}} /// namespace eosio::base58
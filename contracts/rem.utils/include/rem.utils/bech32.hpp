@@ -0,0 +1,133 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace eosio { namespace bech32 {
+
+   /**
+    * The bech32 data alphabet, a character encodes 5 bits.
+    */
+   constexpr char charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+   /**
+    * Build the lower case character to 5-bit value decode table, -1 marks characters outside of the alphabet.
+    */
+   constexpr std::array<int8_t, 256> make_decode_map() {
+      std::array<int8_t, 256> map{};
+      for (size_t i = 0; i < map.size(); ++i)
+         map[i] = -1;
+      for (size_t i = 0; i < sizeof(charset) - 1; ++i)
+         map[static_cast<uint8_t>(charset[i])] = static_cast<int8_t>(i);
+      return map;
+   }
+
+   inline constexpr std::array<int8_t, 256> decode_map = make_decode_map();
+
+   enum class decode_status : uint8_t {
+      ok = 0,
+      invalid_format,
+      invalid_checksum,
+      invalid_program
+   };
+
+   namespace detail {
+      constexpr size_t max_size      = 90;
+      constexpr size_t checksum_size = 6;
+      constexpr uint32_t bech32_constant  = 1;
+      constexpr uint32_t bech32m_constant = 0x2bc830a3;
+
+      constexpr uint32_t polymod_step(uint32_t chk, uint8_t value) {
+         const uint32_t top = chk >> 25;
+         chk = ((chk & 0x1ffffff) << 5) ^ value;
+         if (top & 1)  chk ^= 0x3b6a57b2;
+         if (top & 2)  chk ^= 0x26508e6d;
+         if (top & 4)  chk ^= 0x1ea119fa;
+         if (top & 8)  chk ^= 0x3d4233dd;
+         if (top & 16) chk ^= 0x2a1462b3;
+         return chk;
+      }
+
+      constexpr char to_lower(char c) { return 'A' <= c && c <= 'Z' ? c - 'A' + 'a' : c; }
+   } // namespace detail
+
+   /**
+    * Validate segregated witness address `address` with human-readable part `hrp` (BIP-173 and BIP-350).
+    *
+    * @details Version 0 witness programs have to be 20 or 32 bytes long and use the bech32 checksum,
+    * programs of later versions use the bech32m checksum.
+    *
+    * @return decode_status::invalid_format if the characters, the case or the human-readable part are wrong,
+    * decode_status::invalid_checksum if the checksum doesn't match, decode_status::invalid_program if
+    * the witness version or program is not allowed.
+    */
+   constexpr decode_status validate_segwit(std::string_view hrp, std::string_view address) {
+      if (address.size() < hrp.size() + 1 + detail::checksum_size + 1 || address.size() > detail::max_size)
+         return decode_status::invalid_format;
+      if (address[hrp.size()] != '1')
+         return decode_status::invalid_format;
+
+      bool has_lower = false;
+      bool has_upper = false;
+      for (const char c : address) {
+         if (c < 33 || c > 126)
+            return decode_status::invalid_format;
+         has_lower |= 'a' <= c && c <= 'z';
+         has_upper |= 'A' <= c && c <= 'Z';
+      }
+      if (has_lower && has_upper)
+         return decode_status::invalid_format;
+
+      uint32_t chk = 1;
+      for (size_t i = 0; i < hrp.size(); ++i) {
+         if (detail::to_lower(address[i]) != hrp[i])
+            return decode_status::invalid_format;
+         chk = detail::polymod_step(chk, static_cast<uint8_t>(hrp[i]) >> 5);
+      }
+      chk = detail::polymod_step(chk, 0);
+      for (const char c : hrp)
+         chk = detail::polymod_step(chk, static_cast<uint8_t>(c) & 0x1f);
+
+      const std::string_view data = address.substr(hrp.size() + 1);
+      const size_t program_digits = data.size() - detail::checksum_size;
+      uint8_t version = 0;
+      uint32_t acc = 0;
+      uint32_t bits = 0;
+      size_t program_size = 0;
+      for (size_t i = 0; i < data.size(); ++i) {
+         const int8_t value = decode_map[static_cast<uint8_t>(detail::to_lower(data[i]))];
+         if (value < 0)
+            return decode_status::invalid_format;
+         chk = detail::polymod_step(chk, static_cast<uint8_t>(value));
+
+         if (i == 0) {
+            version = static_cast<uint8_t>(value);
+         } else if (i < program_digits) {
+            acc = (acc << 5) | static_cast<uint32_t>(value);
+            bits += 5;
+            if (bits >= 8) {
+               bits -= 8;
+               ++program_size;
+            }
+         }
+      }
+
+      const uint32_t expected = version == 0 ? detail::bech32_constant : detail::bech32m_constant;
+      if (chk != expected)
+         return chk == detail::bech32_constant || chk == detail::bech32m_constant ? decode_status::invalid_program
+                                                                                  : decode_status::invalid_checksum;
+      // padding of the 5 to 8 bit conversion must be shorter than 5 bits and zero
+      if (version > 16 || bits >= 5 || (acc & ((1u << bits) - 1)) != 0)
+         return decode_status::invalid_program;
+      if (program_size < 2 || program_size > 40 || (version == 0 && program_size != 20 && program_size != 32))
+         return decode_status::invalid_program;
+      return decode_status::ok;
+   }
+
+}} /// namespace eosio::bech32
@@ -0,0 +1,30 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <string>
+#include <type_traits>
+
+namespace eosio {
+
+   /**
+    * Assert that `pred` is true with the message returned by `format_msg`.
+    *
+    * @details The message is formatted only when the assertion fails, so checks on hot paths don't build
+    * diagnostic strings that are never used.
+    *
+    * @param pred - the condition to check,
+    * @param format_msg - the callable returning the message of the failed assertion.
+    */
+   template <typename Format, typename = std::enable_if_t<std::is_invocable_r_v<std::string, Format>>>
+   inline void check(bool pred, Format &&format_msg) {
+      if (!pred) {
+         const std::string msg = format_msg();
+         check(false, msg.c_str(), msg.size());
+      }
+   }
+} /// namespace eosio
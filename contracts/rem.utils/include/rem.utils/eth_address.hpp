@@ -0,0 +1,69 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <rem.utils/keccak.hpp>
+
+#include <string_view>
+
+namespace eosio { namespace eth {
+
+   /**
+    * The number of hex digits in an ethereum address without the "0x" prefix.
+    */
+   constexpr size_t address_size = 40;
+
+   enum class address_status : uint8_t {
+      ok = 0,
+      invalid_length,
+      invalid_symbol,
+      invalid_checksum
+   };
+
+   namespace detail {
+      constexpr bool is_hex_digit(char c) {
+         return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+      }
+
+      constexpr bool is_upper(char c) { return 'A' <= c && c <= 'F'; }
+
+      constexpr char to_lower(char c) { return is_upper(c) ? c - 'A' + 'a' : c; }
+   } // namespace detail
+
+   /**
+    * Validate ethereum address `address` with or without the "0x" prefix.
+    *
+    * @details A lower case address is accepted as is, an address with upper case letters has to match its
+    * EIP-55 checksum: a letter is upper case only if the corresponding nibble of the Keccak-256 hash of the
+    * lower case address is 8 or greater.
+    */
+   constexpr address_status validate_address(std::string_view address) {
+      if (address.substr(0, 2) == "0x")
+         address.remove_prefix(2);
+      if (address.size() != address_size)
+         return address_status::invalid_length;
+
+      std::array<uint8_t, address_size> lower{};
+      bool has_upper = false;
+      for (size_t i = 0; i < address_size; ++i) {
+         const char c = address[i];
+         if (!detail::is_hex_digit(c))
+            return address_status::invalid_symbol;
+         has_upper |= detail::is_upper(c);
+         lower[i] = static_cast<uint8_t>(detail::to_lower(c));
+      }
+      if (!has_upper)
+         return address_status::ok;
+
+      const auto hash = keccak::hash_256(lower);
+      for (size_t i = 0; i < address_size; ++i) {
+         const uint8_t nibble = (i % 2 ? hash[i / 2] : hash[i / 2] >> 4) & 0x0f;
+         if (address[i] > '9' && detail::is_upper(address[i]) != (nibble >= 8))
+            return address_status::invalid_checksum;
+      }
+      return address_status::ok;
+   }
+
+}} /// namespace eosio::eth
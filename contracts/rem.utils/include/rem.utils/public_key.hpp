@@ -0,0 +1,46 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/crypto.hpp>
+
+#include <rem.utils/base58.hpp>
+
+#include <cstring>
+
+namespace eosio {
+
+   template <size_t size>
+   inline std::array<uint8_t, size> base58_to_binary(std::string_view s) {
+      std::array<uint8_t, size> result;
+      switch (base58::decode(s, result)) {
+         case base58::decode_status::invalid_digit:
+            check(false, "invalid base-58 value");
+            break;
+         case base58::decode_status::out_of_range:
+            check(false, "base-58 value is out of range");
+            break;
+         default:
+            break;
+      }
+      return result;
+   }
+
+   inline public_key string_to_public_key(std::string_view s) {
+      constexpr size_t key_size = 33;
+      constexpr size_t checksum_size = 4;
+
+      bool is_k1_type = s.size() >= 3 && (s.substr(0, 3) == "EOS" || s.substr(0, 3) == "REM");
+      bool is_r1_type = s.size() >= 7 && s.substr(0, 7) == "PUB_R1_";
+      check(is_k1_type || is_r1_type, "unrecognized public key format");
+
+      const auto whole = base58_to_binary<key_size + checksum_size>(is_k1_type ? s.substr(3) : s.substr(7));
+
+      std::array<char, key_size> key_data;
+      std::memcpy(key_data.data(), whole.data(), key_size);
+      return is_k1_type ? public_key(std::in_place_index<0>, key_data) : public_key(std::in_place_index<1>, key_data);
+   }
+} /// namespace eosio
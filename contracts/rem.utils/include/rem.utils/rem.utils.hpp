@@ -7,6 +7,8 @@
 #include <eosio/asset.hpp>
 #include <eosio/eosio.hpp>
 
+#include <rem.utils/validate_address.hpp>
+
 namespace eosio {
 
    using std::string;
@@ -19,6 +21,7 @@ namespace eosio {
     *
     * @details rem.utils contract defines the structures and actions that allow users and contracts to use helpful
     * tools. Implement validation address another blockchain.
+    * Supported address formats are listed in the address_validators registry of rem.utils/validate_address.hpp.
     * @{
     */
    class [[eosio::contract("rem.utils")]] utils : public contract {
@@ -28,7 +31,8 @@ namespace eosio {
       /**
        * Validate address action.
        *
-       * @details Validation blockchain address.
+       * @details Validation blockchain address, contracts can use the same validation without an inline action
+       * by including rem.utils/validate_address.hpp.
        *
        * @param name - the chain id address validation for,
        * @param address - the address in the corresponding chain network.
@@ -36,13 +40,20 @@ namespace eosio {
       [[eosio::action]]
       void validateaddr( const name& chain_id, const string& address );
 
+      /**
+       * Validate addresses batch action.
+       *
+       * @details Validation of several blockchain addresses of the same chain in one action, fails on the first
+       * invalid address. Unlike validateaddr the chain has to have a known address format.
+       *
+       * @param chain_id - the chain id addresses validation for,
+       * @param addresses - the addresses in the corresponding chain network.
+       */
+      [[eosio::action]]
+      void validatemany( const name& chain_id, const std::vector<string>& addresses );
+
       using validate_address_action = action_wrapper<"validateaddr"_n, &utils::validateaddr>;
-   private:
-      void validate_eth_address(string address);
-      void validate_eth_address_checksum(string checksum_address);
-      string bytetohex(unsigned char *data, int len);
-      std::array<unsigned char, 32> sha3_256(const string& address);
-      bool is_lower(const string &address);
+      using validate_many_action = action_wrapper<"validatemany"_n, &utils::validatemany>;
    };
    /** @}*/ // end of @defgroup eosioutils rem.utils
 } /// namespace eosio
@@ -0,0 +1,133 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/name.hpp>
+
+#include <rem.utils/base58.hpp>
+#include <rem.utils/bech32.hpp>
+#include <rem.utils/eth_address.hpp>
+
+#include <cstring>
+
+namespace eosio {
+
+   enum class address_format : uint8_t {
+      ethereum, // hex address with an optional EIP-55 checksum
+      bitcoin   // Base58Check pay-to-pubkey-hash and pay-to-script-hash or bech32 segwit address
+   };
+
+   /**
+    * Address validation parameters of a chain.
+    */
+   struct address_validator {
+      name              chain_id;
+      address_format    format;
+      uint8_t           pubkey_hash_version = 0; // Base58Check version byte of pay-to-pubkey-hash addresses
+      uint8_t           script_hash_version = 0; // Base58Check version byte of pay-to-script-hash addresses
+      std::string_view  bech32_hrp;              // human-readable part of segwit addresses
+   };
+
+   /**
+    * Chains with a known address format, addresses of other chains are not validated by validate_address.
+    */
+   inline constexpr address_validator address_validators[] = {
+      { "eth"_n,        address_format::ethereum },
+      { "ethropsten"_n, address_format::ethereum },
+      { "btc"_n,        address_format::bitcoin, 0x00, 0x05, "bc" },
+      { "btctestnet"_n, address_format::bitcoin, 0x6f, 0xc4, "tb" },
+   };
+
+   constexpr const address_validator* find_address_validator(const name &chain_id) {
+      for (const auto &validator : address_validators) {
+         if (validator.chain_id == chain_id)
+            return &validator;
+      }
+      return nullptr;
+   }
+
+   inline const char* get_eth_address_error(std::string_view address) {
+      switch (eth::validate_address(address)) {
+         case eth::address_status::invalid_length:
+            return "invalid address length";
+         case eth::address_status::invalid_symbol:
+            return "invalid hex symbol in ethereum address";
+         case eth::address_status::invalid_checksum:
+            return "invalid ethereum address checksum";
+         default:
+            return nullptr;
+      }
+   }
+
+   inline const char* get_base58check_address_error(const address_validator &validator, std::string_view address) {
+      constexpr size_t payload_size = 21; // version byte and 20 bytes hash
+      constexpr size_t checksum_size = 4;
+
+      std::array<uint8_t, payload_size + checksum_size> data;
+      if (base58::decode(address, data) != base58::decode_status::ok)
+         return "invalid base-58 address";
+
+      // leading '1' digits have to encode exactly the leading zero bytes
+      size_t leading_ones = 0;
+      while (leading_ones < address.size() && address[leading_ones] == '1')
+         ++leading_ones;
+      size_t leading_zeros = 0;
+      while (leading_zeros < data.size() && data[leading_zeros] == 0)
+         ++leading_zeros;
+      if (leading_ones != leading_zeros)
+         return "invalid base-58 address";
+
+      if (data[0] != validator.pubkey_hash_version && data[0] != validator.script_hash_version)
+         return "invalid address version";
+
+      const auto hash = sha256(reinterpret_cast<const char*>(data.data()), payload_size).extract_as_byte_array();
+      const auto checksum = sha256(reinterpret_cast<const char*>(hash.data()), hash.size()).extract_as_byte_array();
+      if (std::memcmp(checksum.data(), data.data() + payload_size, checksum_size) != 0)
+         return "invalid address checksum";
+      return nullptr;
+   }
+
+   inline const char* get_bech32_address_error(const address_validator &validator, std::string_view address) {
+      switch (bech32::validate_segwit(validator.bech32_hrp, address)) {
+         case bech32::decode_status::invalid_format:
+            return "invalid bech32 address";
+         case bech32::decode_status::invalid_checksum:
+            return "invalid address checksum";
+         case bech32::decode_status::invalid_program:
+            return "invalid witness program";
+         default:
+            return nullptr;
+      }
+   }
+
+   inline const char* get_address_error(const address_validator &validator, std::string_view address) {
+      switch (validator.format) {
+         case address_format::ethereum:
+            return get_eth_address_error(address);
+         case address_format::bitcoin: {
+            const std::string_view hrp = validator.bech32_hrp;
+            bool is_segwit = address.size() > hrp.size() && address[hrp.size()] == '1';
+            for (size_t i = 0; is_segwit && i < hrp.size(); ++i)
+               is_segwit = (address[i] | 0x20) == hrp[i];
+            return is_segwit ? get_bech32_address_error(validator, address)
+                             : get_base58check_address_error(validator, address);
+         }
+      }
+      return nullptr;
+   }
+
+   /**
+    * Validate `address` in the network with chain identifier `chain_id`, addresses of unknown networks are not checked.
+    */
+   inline void validate_address(const name &chain_id, std::string_view address) {
+      const address_validator *validator = find_address_validator(chain_id);
+      if (validator != nullptr) {
+         const char* error = get_address_error(*validator, address);
+         check(error == nullptr, error);
+      }
+   }
+} /// namespace eosio
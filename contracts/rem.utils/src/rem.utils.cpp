@@ -7,10 +7,21 @@
 namespace eosio {
 
    void utils::validateaddr( const name& chain_id, const string& address ) {
-      if (chain_id.to_string() == "ethropsten" || chain_id.to_string() == "eth") {
-         validate_eth_address(address);
+      validate_address(chain_id, address);
+   }
+
+   void utils::validatemany( const name& chain_id, const std::vector<string>& addresses ) {
+      check( !addresses.empty(), "empty addresses list" );
+      const address_validator* validator = find_address_validator(chain_id);
+      check( validator != nullptr, "not supported chain id" );
+
+      for (size_t i = 0; i < addresses.size(); ++i) {
+         const char* error = get_address_error(*validator, addresses[i]);
+         if (error) {
+            check( false, string(error) + " at position " + std::to_string(i) );
+         }
       }
    }
 } /// namespace eosio
 
-EOSIO_DISPATCH( eosio::utils, (validateaddr) )
+EOSIO_DISPATCH( eosio::utils, (validateaddr)(validatemany) )
@@ -0,0 +1,62 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include <eosio/eosio.hpp>
+
+#include <rem.attr/rem.attr.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Test contract reading attributes of rem.attr through the typed helpers of rem.attr.hpp,
+    * each action fails if the value read differs from `expected`, std::nullopt means the value is not found.
+    */
+   class [[eosio::contract("attr.reader")]] attr_reader : public contract {
+   public:
+      using contract::contract;
+
+      [[eosio::action]]
+      void readstring( const name& attr_contract, const name& issuer, const name& receiver, const name& attribute_name,
+                       const std::optional<std::string>& expected )
+      {
+         std::optional<std::string> value;
+         attribute::visit_attribute< attribute::data_type::UTFString >( attr_contract, issuer, receiver, attribute_name,
+            [&]( std::string_view v ) { value.emplace( v.begin(), v.end() ); } );
+         check( value == expected, "unexpected value" );
+      }
+
+      [[eosio::action]]
+      void readbinary( const name& attr_contract, const name& issuer, const name& receiver, const name& attribute_name,
+                       const std::optional<std::vector<char>>& expected )
+      {
+         std::optional<std::vector<char>> value;
+         attribute::visit_attribute< attribute::data_type::Binary >( attr_contract, issuer, receiver, attribute_name,
+            [&]( attribute_bytes v ) { value.emplace( v.begin(), v.end() ); } );
+         check( value == expected, "unexpected value" );
+      }
+
+      [[eosio::action]]
+      void readaccount( const name& attr_contract, const name& issuer, const name& receiver, const name& attribute_name,
+                        const std::optional<std::vector<char>>& expected )
+      {
+         std::optional<std::vector<char>> value;
+         attribute::visit_attribute< attribute::data_type::ChainAccount >( attr_contract, issuer, receiver, attribute_name,
+            [&]( const std::array<char, 40>& v ) { value.emplace( v.begin(), v.end() ); } );
+         check( value == expected, "unexpected value" );
+      }
+
+      [[eosio::action]]
+      void readlargeint( const name& attr_contract, const name& issuer, const name& receiver, const name& attribute_name,
+                         const std::optional<int64_t>& expected )
+      {
+         const auto value = attribute::find_attribute< attribute::data_type::LargeInt >( attr_contract, issuer, receiver, attribute_name );
+         check( value == expected, "unexpected value" );
+      }
+   };
+
+} /// namespace eosio
@@ -0,0 +1,31 @@
+/**
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include <eosio/eosio.hpp>
+
+#include <rem.token/rem.token.hpp>
+
+#include <optional>
+
+namespace eosio {
+
+   /**
+    * Test contract reading balances of rem.token through the helpers of rem.token.hpp,
+    * each action fails if the balance read differs from `expected`, std::nullopt means the balance is not found.
+    */
+   class [[eosio::contract("token.reader")]] token_reader : public contract {
+   public:
+      using contract::contract;
+
+      [[eosio::action]]
+      void readbalance( const name& token_contract, const name& owner, const symbol_code& sym_code, const block_timestamp& time,
+                        const std::optional<asset>& expected )
+      {
+         const auto balance = token::get_balance_at( token_contract, owner, sym_code, time );
+         check( balance.has_value() == expected.has_value(), "unexpected balance" );
+         check( !balance || (balance->symbol == expected->symbol && balance->amount == expected->amount), "unexpected balance" );
+      }
+   };
+
+} /// namespace eosio
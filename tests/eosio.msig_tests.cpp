@@ -303,6 +303,105 @@ BOOST_FIXTURE_TEST_CASE( propose_with_wrong_requested_auth, eosio_msig_tester )
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_FIXTURE_TEST_CASE( propose_approve_sorted_approvals, eosio_msig_tester ) try {
+   vector<permission_level> requested = { { N(carol), config::active_name }, { N(alice), config::active_name },
+                                          { N(bob), config::active_name }, { N(alice), config::active_name } };
+   auto trx = reqauth( N(alice), vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name } }, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested",     requested)
+   );
+
+   auto get_approvals = [&]() {
+      return get_row_by_account( N(rem.msig), N(alice), N(approvals3), N(first) );
+   };
+   const auto proposed_data = get_approvals();
+   BOOST_REQUIRE( !proposed_data.empty() );
+   auto apps = abi_ser.binary_to_variant( "approvals_set", proposed_data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   const auto& levels = apps["requested_approvals"].get_array();
+   //requested approvals are sorted and the duplicates are dropped
+   BOOST_REQUIRE_EQUAL( 3, levels.size() );
+   BOOST_REQUIRE_EQUAL( "alice", levels[0]["actor"].as_string() );
+   BOOST_REQUIRE_EQUAL( "bob", levels[1]["actor"].as_string() );
+   BOOST_REQUIRE_EQUAL( "carol", levels[2]["actor"].as_string() );
+   BOOST_REQUIRE_EQUAL( 3, apps["approval_times"].get_array().size() );
+
+   push_action( N(bob), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(bob), config::active_name })
+   );
+   //the size of the row doesn't change on approve
+   BOOST_REQUIRE_EQUAL( proposed_data.size(), get_approvals().size() );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(bob), N(approve), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(bob), config::active_name })
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("approval is not on the list of requested approvals")
+   );
+
+   push_action( N(carol), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(carol), config::active_name })
+   );
+   push_action( N(carol), N(unapprove), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(carol), config::active_name })
+   );
+   BOOST_REQUIRE_EQUAL( proposed_data.size(), get_approvals().size() );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(carol), N(unapprove), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(carol), config::active_name })
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("no approval previously granted")
+   );
+
+   //fail because approval by alice is missing
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(exec), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("executer",      "alice")
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("transaction authorization failed")
+   );
+
+   push_action( N(alice), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         permission_level{ N(alice), config::active_name })
+   );
+
+   transaction_trace_ptr trace;
+   control->applied_transaction.connect(
+   [&]( std::tuple<const transaction_trace_ptr&, const signed_transaction&> p ) {
+      const auto& t = std::get<0>(p);
+      if( t->scheduled ) { trace = t; }
+   } );
+
+   push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+
+   BOOST_REQUIRE( bool(trace) );
+   BOOST_REQUIRE_EQUAL( 1, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+   BOOST_REQUIRE( get_approvals().empty() );
+} FC_LOG_AND_RETHROW()
+
+
 BOOST_FIXTURE_TEST_CASE( big_transaction, eosio_msig_tester ) try {
    vector<permission_level> perm = { { N(alice), config::active_name }, { N(bob), config::active_name } };
    auto wasm = contracts::util::exchange_wasm();
@@ -735,6 +834,88 @@ BOOST_FIXTURE_TEST_CASE( propose_invalidate_approve, eosio_msig_tester ) try {
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( propose_approve_invalidate_by_three, eosio_msig_tester ) try {
+   const vector<permission_level> requested = { { N(alice), config::active_name }, { N(bob), config::active_name },
+                                                { N(carol), config::active_name } };
+   auto trx = reqauth( N(alice), requested, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested",     requested)
+   );
+
+   auto approve = [&]( name actor ) {
+      push_action( actor, N(approve), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         permission_level{ actor, config::active_name })
+      );
+   };
+   auto unapprove = [&]( name actor ) {
+      push_action( actor, N(unapprove), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         permission_level{ actor, config::active_name })
+      );
+   };
+   auto invalidate = [&]( name actor ) {
+      push_action( actor, N(invalidate), mvo()
+                     ("account",      actor)
+      );
+   };
+   auto require_exec_failure = [&]() {
+      BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(exec), mvo()
+                                             ("proposer",      "alice")
+                                             ("proposal_name", "first")
+                                             ("executer",      "alice")
+                               ),
+                               eosio_assert_message_exception,
+                               eosio_assert_message_is("transaction authorization failed")
+      );
+   };
+
+   //alice approves before her invalidation, carol invalidates before her approval,
+   //bob sits between them and has no invalidation
+   approve( N(alice) );
+   invalidate( N(alice) );
+   invalidate( N(carol) );
+   approve( N(bob) );
+   approve( N(carol) );
+
+   //the approval of alice is dropped
+   require_exec_failure();
+
+   //alice approves again after her invalidation
+   unapprove( N(alice) );
+   approve( N(alice) );
+
+   //carol invalidates after her approval, so it is dropped now
+   invalidate( N(carol) );
+   require_exec_failure();
+
+   //carol approves again after her last invalidation
+   unapprove( N(carol) );
+   approve( N(carol) );
+
+   transaction_trace_ptr trace;
+   control->applied_transaction.connect(
+   [&]( std::tuple<const transaction_trace_ptr&, const signed_transaction&> p ) {
+      const auto& t = std::get<0>(p);
+      if( t->scheduled ) { trace = t; }
+   } );
+
+   push_action( N(bob), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "bob")
+   );
+
+   BOOST_REQUIRE( bool(trace) );
+   BOOST_REQUIRE_EQUAL( 1, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE( approve_execute_old, eosio_msig_tester ) try {
    set_code( N(rem.msig), contracts::util::msig_wasm_old() );
    set_abi( N(rem.msig), contracts::util::msig_abi_old().data() );
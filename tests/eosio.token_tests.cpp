@@ -65,6 +65,12 @@ public:
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "account", data, abi_serializer::create_yield_function( abi_serializer_max_time ) );
    }
 
+   fc::variant get_checkpoint( account_name acc, uint64_t id )
+   {
+      vector<char> data = get_row_by_account( N(rem.token), acc, N(checkpoints), name(id) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "checkpoint", data, abi_serializer::create_yield_function( abi_serializer_max_time ) );
+   }
+
    action_result create( account_name issuer,
                 asset        maximum_supply ) {
 
@@ -94,6 +100,44 @@ public:
       );
    }
 
+   action_result transfermany( account_name from,
+                               const vector<std::pair<account_name, asset>>& transfers,
+                               string memo ) {
+      fc::variants transfers_var;
+      for (const auto& [to, quantity] : transfers) {
+         transfers_var.push_back(mvo()("first", to)("second", quantity));
+      }
+      return push_action( from, N(transfermany), mvo()
+           ( "from", from)
+           ( "transfers", transfers_var)
+           ( "memo", memo)
+      );
+   }
+
+   // pushes a transfer in its own transaction and returns the time spent executing it in rem.token,
+   // billed CPU is rounded up to the minimal transaction CPU usage and hides the difference
+   int64_t transfer_cpu_usage( account_name from, account_name to, asset quantity, string memo ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{ {from, config::active_name} }, N(rem.token), N(transfer),
+                                abi_ser.variant_to_binary( "transfer", mvo()
+                                   ( "from", from)
+                                   ( "to", to)
+                                   ( "quantity", quantity)
+                                   ( "memo", memo),
+                                   abi_serializer::create_yield_function( abi_serializer_max_time ) ) );
+      set_transaction_headers( trx );
+      trx.sign( get_private_key( from, "active" ), control->get_chain_id() );
+      auto trace = push_transaction( trx );
+      return trace->action_traces.front().elapsed.count();
+   }
+
+   action_result setcheckpt( account_name issuer, const string& sym_code, uint32_t period ) {
+      return push_action( issuer, N(setcheckpt), mvo()
+           ( "sym_code", sym_code)
+           ( "period", period)
+      );
+   }
+
    abi_serializer abi_ser;
 };
 
@@ -265,4 +309,206 @@ BOOST_FIXTURE_TEST_CASE( transfer_tests, eosio_token_tester ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( transfermany_tests, eosio_token_tester ) try {
+
+   create( N(alice), asset::from_string("1000 CERO"));
+   create( N(alice), asset::from_string("1000.000 TKN"));
+   produce_blocks(1);
+
+   issue( N(alice), N(alice), asset::from_string("1000 CERO"), "hola" );
+   issue( N(alice), N(alice), asset::from_string("1000.000 TKN"), "hola" );
+
+   BOOST_REQUIRE_EQUAL( success(),
+      transfermany( N(alice), { { N(bob), asset::from_string("300 CERO") },
+                                { N(carol), asset::from_string("200 CERO") },
+                                { N(bob), asset::from_string("100 CERO") } }, "hola" )
+   );
+
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "400 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", "400 CERO")
+   );
+   REQUIRE_MATCHING_OBJECT( get_account(N(carol), "0,CERO"), mvo()
+      ("balance", "200 CERO")
+   );
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "empty transfers list" ),
+      transfermany( N(alice), {}, "hola" )
+   );
+   // the sum of the quantities is checked against the balance
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "overdrawn balance" ),
+      transfermany( N(alice), { { N(bob), asset::from_string("300 CERO") },
+                                { N(carol), asset::from_string("101 CERO") } }, "hola" )
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "must transfer positive quantity" ),
+      transfermany( N(alice), { { N(bob), asset::from_string("1 CERO") },
+                                { N(carol), asset::from_string("-1 CERO") } }, "hola" )
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ),
+      transfermany( N(alice), { { N(bob), asset::from_string("1 CERO") },
+                                { N(carol), asset::from_string("1.000 TKN") } }, "hola" )
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "cannot transfer to self" ),
+      transfermany( N(alice), { { N(bob), asset::from_string("1 CERO") },
+                                { N(alice), asset::from_string("1 CERO") } }, "hola" )
+   );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "to account does not exist" ),
+      transfermany( N(alice), { { N(dave), asset::from_string("1 CERO") } }, "hola" )
+   );
+
+   REQUIRE_MATCHING_OBJECT( get_account(N(alice), "0,CERO"), mvo()
+      ("balance", "400 CERO")
+   );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( checkpoint_tests, eosio_token_tester ) try {
+
+   create( N(alice), asset::from_string("1000 CERO"));
+   create( N(alice), asset::from_string("1000.000 TKN"));
+   issue( N(alice), N(alice), asset::from_string("1000 CERO"), "hola" );
+   issue( N(alice), N(alice), asset::from_string("1000.000 TKN"), "hola" );
+   produce_blocks(1);
+
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "token with symbol does not exist" ),
+      setcheckpt( N(alice), "NONE", 60 )
+   );
+   BOOST_REQUIRE_EQUAL( error( "missing authority of alice" ),
+      setcheckpt( N(bob), "CERO", 60 )
+   );
+   const auto start_time = control->pending_block_time();
+   BOOST_REQUIRE_EQUAL( success(), setcheckpt( N(alice), "CERO", 60 ) );
+   BOOST_REQUIRE_EQUAL( 60u, get_stats("0,CERO")["checkpoint_period"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( string(start_time), get_stats("0,CERO")["checkpoint_start"].as_string() );
+
+   // changes of one period are kept in one checkpoint with the last balance and the time of the first change
+   produce_block( fc::seconds(60 - control->pending_block_time().sec_since_epoch() % 60) );
+   const auto first_period_time = control->pending_block_time();
+   transfer( N(alice), N(bob), asset::from_string("100 CERO"), "hola" );
+   transfer( N(alice), N(bob), asset::from_string("50 CERO"), "hola" );
+   produce_blocks(1);
+   transfer( N(bob), N(carol), asset::from_string("20 CERO"), "hola" );
+   // tokens without checkpoints are not recorded
+   transfer( N(alice), N(bob), asset::from_string("1.000 TKN"), "hola" );
+
+   // the first checkpoint of an account is preceded by its balance from the time the checkpoints were turned on
+   auto checkpoint = get_checkpoint( N(bob), 0 );
+   BOOST_REQUIRE_EQUAL( "0 CERO", checkpoint["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( string(start_time), checkpoint["time"].as_string() );
+   checkpoint = get_checkpoint( N(bob), 1 );
+   BOOST_REQUIRE_EQUAL( "130 CERO", checkpoint["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( string(first_period_time), checkpoint["time"].as_string() );
+   BOOST_REQUIRE_EQUAL( "1000 CERO", get_checkpoint( N(alice), 0 )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "850 CERO", get_checkpoint( N(alice), 1 )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "0 CERO", get_checkpoint( N(carol), 0 )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "20 CERO", get_checkpoint( N(carol), 1 )["balance"].as_string() );
+   BOOST_REQUIRE( get_checkpoint( N(bob), 2 ).is_null() );
+
+   // the next period starts a new checkpoint
+   produce_block( fc::seconds(60) );
+   transfer( N(alice), N(bob), asset::from_string("10 CERO"), "hola" );
+   BOOST_REQUIRE_EQUAL( "140 CERO", get_checkpoint( N(bob), 2 )["balance"].as_string() );
+   BOOST_REQUIRE_EQUAL( "130 CERO", get_checkpoint( N(bob), 1 )["balance"].as_string() );
+
+   // checkpoints can't be turned off, the period can be changed and the start time is kept
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "checkpoint period must be positive, checkpoints can't be turned off" ),
+      setcheckpt( N(alice), "CERO", 0 )
+   );
+   BOOST_REQUIRE_EQUAL( success(), setcheckpt( N(alice), "CERO", 120 ) );
+   BOOST_REQUIRE_EQUAL( string(start_time), get_stats("0,CERO")["checkpoint_start"].as_string() );
+   produce_block( fc::seconds(120) );
+   transfer( N(alice), N(bob), asset::from_string("10 CERO"), "hola" );
+   BOOST_REQUIRE_EQUAL( "150 CERO", get_checkpoint( N(bob), 3 )["balance"].as_string() );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( get_balance_at_tests, eosio_token_tester ) try {
+
+   create_accounts( { N(token.reader) } );
+   set_code( N(token.reader), contracts::util::token_reader_wasm() );
+   set_abi( N(token.reader), contracts::util::token_reader_abi().data() );
+
+   create( N(alice), asset::from_string("1000 CERO"));
+   issue( N(alice), N(alice), asset::from_string("1000 CERO"), "hola" );
+   produce_blocks(1);
+   const auto start_time = control->pending_block_time();
+   BOOST_REQUIRE_EQUAL( success(), setcheckpt( N(alice), "CERO", 60 ) );
+   produce_block( fc::seconds(60 - control->pending_block_time().sec_since_epoch() % 60) );
+
+   // pushes a readbalance action of token.reader, which fails if the balance read differs from `expected`
+   auto read_balance = [&]( account_name owner, const string& sym_code, fc::time_point time, const fc::variant& expected ) {
+      base_tester::push_action( N(token.reader), N(readbalance), N(token.reader), mvo()
+         ( "token_contract", N(rem.token) )
+         ( "owner", owner )
+         ( "sym_code", sym_code )
+         ( "time", string(time) )
+         ( "expected", expected )
+      );
+   };
+
+   // alice holds tokens issued before the checkpoints were turned on and has no checkpoint yet
+   read_balance( N(alice), "CERO", control->pending_block_time(), fc::variant("1000 CERO") );
+   read_balance( N(alice), "CERO", start_time, fc::variant("1000 CERO") );
+   read_balance( N(alice), "CERO", start_time - fc::milliseconds(config::block_interval_ms), fc::variant() );
+
+   const auto first_time = control->pending_block_time();
+   transfer( N(alice), N(bob), asset::from_string("100 CERO"), "hola" );
+   produce_block( fc::seconds(60) );
+   const auto second_time = control->pending_block_time();
+   transfer( N(alice), N(bob), asset::from_string("10 CERO"), "hola" );
+   produce_blocks(1);
+   // inside a period the balance at its end is returned
+   transfer( N(alice), N(bob), asset::from_string("5 CERO"), "hola" );
+   produce_blocks(1);
+
+   read_balance( N(bob), "CERO", start_time - fc::milliseconds(config::block_interval_ms), fc::variant() );
+   read_balance( N(bob), "CERO", start_time, fc::variant("0 CERO") );
+   read_balance( N(bob), "CERO", first_time - fc::milliseconds(config::block_interval_ms), fc::variant("0 CERO") );
+   read_balance( N(bob), "CERO", first_time, fc::variant("100 CERO") );
+   read_balance( N(bob), "CERO", second_time - fc::seconds(1), fc::variant("100 CERO") );
+   read_balance( N(bob), "CERO", second_time, fc::variant("115 CERO") );
+   read_balance( N(bob), "CERO", control->pending_block_time(), fc::variant("115 CERO") );
+   // the balance held when the checkpoints were turned on is kept after the first change
+   read_balance( N(alice), "CERO", start_time, fc::variant("1000 CERO") );
+   read_balance( N(alice), "CERO", first_time, fc::variant("900 CERO") );
+   read_balance( N(alice), "CERO", second_time, fc::variant("885 CERO") );
+   // the last checkpoint before the time belongs to another token
+   read_balance( N(bob), "ZZZZ", control->pending_block_time(), fc::variant() );
+   // carol has no balance
+   read_balance( N(carol), "CERO", control->pending_block_time(), fc::variant() );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// benchmarks only report their results, they are skipped by a plain unit_test run and labeled "benchmark" in ctest,
+// run them with "ctest -L benchmark" or "unit_test --run_test=eosio_token_benchmarks"
+BOOST_AUTO_TEST_SUITE(eosio_token_benchmarks, * boost::unit_test::disabled())
+
+BOOST_FIXTURE_TEST_CASE( transfer_benchmark, eosio_token_tester ) try {
+
+   create( N(alice), asset::from_string("1000000 CERO"));
+   issue( N(alice), N(alice), asset::from_string("1000000 CERO"), "hola" );
+   transfer( N(alice), N(bob), asset::from_string("1 CERO"), "hola" );
+   produce_blocks(1);
+
+   const size_t transfers = 500;
+   int64_t total_cpu_us = 0;
+   for (size_t i = 0; i < transfers; ++i) {
+      total_cpu_us += transfer_cpu_usage( N(alice), N(bob), asset::from_string("1 CERO"), "payment " + std::to_string(i) );
+      if (i % 100 == 99) {
+         produce_blocks(1);
+      }
+   }
+
+   REQUIRE_MATCHING_OBJECT( get_account(N(bob), "0,CERO"), mvo()
+      ("balance", std::to_string(transfers + 1) + " CERO")
+   );
+   BOOST_TEST_MESSAGE("transfer CPU usage: " << total_cpu_us << " us for " << transfers << " transfers, "
+                      << total_cpu_us / double(transfers) << " us per transfer");
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -140,6 +140,37 @@ public:
         return r;
     }
 
+    auto set_directory( name attribute_name, bool enabled ) {
+        auto r = base_tester::push_action(N(rem.attr), N(setdirectory), N(rem.attr), mvo()
+            ("attribute_name", attribute_name)
+            ("enabled", enabled)
+        );
+        produce_block();
+        return r;
+    }
+
+    auto list_attrs( name attribute_name, uint64_t max_rows ) {
+        auto r = base_tester::push_action(N(rem.attr), N(listattrs), N(rem.attr), mvo()
+            ("attribute_name", attribute_name)
+            ("max_rows", max_rows)
+        );
+        produce_block();
+        return r;
+    }
+
+    // pushes a read action of attr.reader, which fails if the value read differs from `expected`
+    auto read_attr( name action, name issuer, name receiver, name attribute_name, const fc::variant& expected ) {
+        auto r = base_tester::push_action(N(attr.reader), action, N(attr.reader), mvo()
+            ("attr_contract", N(rem.attr))
+            ("issuer", issuer)
+            ("receiver", receiver)
+            ("attribute_name", attribute_name)
+            ("expected", expected)
+        );
+        produce_block();
+        return r;
+    }
+
     auto set_attr( name issuer, name receiver, name attribute_name, std::string value ) {
         auto r = base_tester::push_action(N(rem.attr), N(setattr), issuer, mvo()
             ("issuer", issuer)
@@ -161,6 +192,30 @@ public:
         return r;
     }
 
+    auto set_attrs( name issuer, name attribute_name, const std::vector<std::pair<name, std::string>>& values ) {
+        fc::variants values_var;
+        for (const auto& [receiver, value] : values) {
+            values_var.push_back(mvo()("first", receiver)("second", value));
+        }
+        auto r = base_tester::push_action(N(rem.attr), N(setattrs), issuer, mvo()
+            ("issuer", issuer)
+            ("attribute_name", attribute_name)
+            ("values", values_var)
+        );
+        produce_block();
+        return r;
+    }
+
+    auto unset_attrs( name issuer, name attribute_name, const std::vector<name>& receivers ) {
+        auto r = base_tester::push_action(N(rem.attr), N(unsetattrs), issuer, mvo()
+            ("issuer", issuer)
+            ("attribute_name", attribute_name)
+            ("receivers", receivers)
+        );
+        produce_block();
+        return r;
+    }
+
     auto invalidate_attr( name attribute_name ) {
         auto r = base_tester::push_action(N(rem.attr), N(invalidate), N(rem.attr), mvo()
             ("attribute_name", attribute_name)
@@ -186,6 +241,11 @@ public:
     }
 
     fc::variant get_account_attribute( const account_name& account, const account_name& issuer, const account_name& attribute ) {
+       const auto attr_obj = get_account_attribute_row( account, issuer, attribute );
+       return attr_obj.is_null() ? attr_obj : attr_obj["attribute"];
+    }
+
+    fc::variant get_account_attribute_row( const account_name& account, const account_name& issuer, const account_name& attribute ) {
       //TODO: figure out how to retrieve object by secondary index
 //       eosio::chain::uint128_t secondary_index_value = account.value;
 //       secondary_index_value <<= 64;
@@ -210,12 +270,28 @@ public:
           const auto attr_obj = abi_ser.binary_to_variant( "attribute_data", data, abi_serializer::create_yield_function( abi_serializer_max_time ) );
           if (attr_obj["receiver"].as_string() == account.to_string() &&
               attr_obj["issuer"].as_string() == issuer.to_string()) {
-             return attr_obj["attribute"];
+             return attr_obj;
           }
        }
         return fc::variant();
     }
 
+    std::vector<fc::variant> get_attribute_directory( const account_name& receiver ) {
+       std::vector<fc::variant> entries;
+       const auto& db = control->db();
+       const auto* t_id = db.find<chain::table_id_object, chain::by_code_scope_table>( boost::make_tuple( N(rem.attr), receiver, N(attrdir) ) );
+       if ( !t_id ) {
+          return entries;
+       }
+
+       const auto& idx = db.get_index<chain::key_value_index, chain::by_scope_primary>();
+       for (auto it = idx.lower_bound( boost::make_tuple( t_id->id, 0 ) ); it != idx.end() && it->t_id == t_id->id; it++) {
+          vector<char> data( it->value.begin(), it->value.end() );
+          entries.push_back( abi_ser.binary_to_variant( "attribute_entry", data, abi_serializer::create_yield_function( abi_serializer_max_time ) ) );
+       }
+       return entries;
+    }
+
     asset get_balance( const account_name& act ) {
          return get_currency_balance(N(rem.token), symbol(CORE_SYMBOL), act);
     }
@@ -507,4 +583,263 @@ BOOST_FIXTURE_TEST_CASE( attribute_test, attribute_tester ) {
     } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( unsetattr_keeps_ids_test, attribute_tester ) {
+    try {
+        create_accounts({N(rem.attr), N(proda), N(prodb), N(prodc)});
+        set_code_abi(N(rem.attr),
+                     contracts::rem_attr_wasm(),
+                     contracts::rem_attr_abi().data());
+
+        create_attr(N(floating), 3, 1); // type: Double, privacy type: PublicPointer
+        for (const auto& receiver : { N(proda), N(prodb), N(prodc) }) {
+            set_attr(N(prodb), receiver, N(floating), "000000000000e03f");
+        }
+        auto attr_info = get_attribute_info(N(floating));
+        BOOST_TEST( 3 == attr_info["next_id"].as_uint64() );
+        BOOST_TEST( 3 == attr_info["count"].as_uint64() );
+
+        // the attributes that stay keep their ids
+        unset_attr(N(prodb), N(proda), N(floating));
+        BOOST_TEST(get_account_attribute_row( N(proda), N(prodb), N(floating)).is_null());
+        BOOST_TEST( 1 == get_account_attribute_row( N(prodb), N(prodb), N(floating))["id"].as_uint64() );
+        BOOST_TEST( 2 == get_account_attribute_row( N(prodc), N(prodb), N(floating))["id"].as_uint64() );
+        attr_info = get_attribute_info(N(floating));
+        BOOST_TEST( 3 == attr_info["next_id"].as_uint64() );
+        BOOST_TEST( 2 == attr_info["count"].as_uint64() );
+
+        // ids of unset attributes are not reused
+        set_attr(N(prodb), N(proda), N(floating), "000000000000e03f");
+        BOOST_TEST( 3 == get_account_attribute_row( N(proda), N(prodb), N(floating))["id"].as_uint64() );
+        attr_info = get_attribute_info(N(floating));
+        BOOST_TEST( 4 == attr_info["next_id"].as_uint64() );
+        BOOST_TEST( 3 == attr_info["count"].as_uint64() );
+
+        for (const auto& receiver : { N(proda), N(prodb), N(prodc) }) {
+            unset_attr(N(prodb), receiver, N(floating));
+        }
+        BOOST_TEST( 0 == get_attribute_info(N(floating))["count"].as_uint64() );
+        invalidate_attr(N(floating));
+        remove_attr(N(floating));
+        BOOST_TEST(get_attribute_info(N(floating)).is_null());
+    } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( bulk_attributes_test, attribute_tester ) {
+    try {
+        create_accounts({N(rem.attr), N(proda), N(prodb), N(prodc)});
+        set_code_abi(N(rem.attr),
+                     contracts::rem_attr_wasm(),
+                     contracts::rem_attr_abi().data());
+
+        create_attr(N(floating), 3, 1); // type: Double,   privacy type: PublicPointer
+        create_attr(N(largeint), 2, 2); // type: LargeInt, privacy type: PublicConfirmedPointer
+        create_attr(N(creator),  0, 3); // type: Bool,     privacy type: PrivatePointer
+
+        set_attr(N(prodb), N(prodb), N(floating), "000000000000e03f"); // value = 0.5
+        set_attrs(N(prodb), N(floating), { { N(proda), "000000000000f03f" },    // value = 1.0
+                                           { N(prodb), "0000000000000040" },    // value = 2.0
+                                           { N(prodc), "0000000000000840" } }); // value = 3.0
+        BOOST_TEST( "000000000000f03f" == get_account_attribute( N(proda), N(prodb), N(floating))["data"].as_string() );
+        BOOST_TEST( "0000000000000040" == get_account_attribute( N(prodb), N(prodb), N(floating))["data"].as_string() );
+        BOOST_TEST( "0000000000000840" == get_account_attribute( N(prodc), N(prodb), N(floating))["data"].as_string() );
+        BOOST_TEST( 0 == get_account_attribute_row( N(prodb), N(prodb), N(floating))["id"].as_uint64() );
+        auto attr_info = get_attribute_info(N(floating));
+        BOOST_TEST( 3 == attr_info["next_id"].as_uint64() );
+        BOOST_TEST( 3 == attr_info["count"].as_uint64() );
+
+        // confirmed attributes are pending until the receiver confirms them
+        set_attrs(N(proda), N(largeint), { { N(prodb), "0100000000000000" }, { N(prodc), "0200000000000000" } });
+        BOOST_TEST( "0100000000000000" == get_account_attribute( N(prodb), N(proda), N(largeint))["pending"].as_string() );
+        confirm_attr(N(prodc), N(proda), N(largeint));
+        BOOST_TEST( "0200000000000000" == get_account_attribute( N(prodc), N(proda), N(largeint))["data"].as_string() );
+
+        BOOST_REQUIRE_EXCEPTION( set_attrs(N(prodb), N(floating), {}),
+                                 eosio_assert_message_exception, eosio_assert_message_is("empty attributes list") );
+        BOOST_REQUIRE_EXCEPTION( unset_attrs(N(prodb), N(floating), {}),
+                                 eosio_assert_message_exception, eosio_assert_message_is("empty receivers list") );
+        // a single invalid value rejects the whole list
+        BOOST_REQUIRE_EXCEPTION( set_attrs(N(prodb), N(floating), { { N(proda), "000000000000f03f" }, { N(prodc), "00" } }),
+                                 eosio_assert_message_exception, eosio_assert_message_is("invalid Double value") );
+        BOOST_REQUIRE_EXCEPTION( set_attrs(N(prodb), N(creator), { { N(proda), "01" } }),
+                                 eosio_assert_message_exception, eosio_assert_message_is("only contract owner can assign this attribute") );
+        BOOST_REQUIRE_EXCEPTION( unset_attrs(N(prodb), N(floating), { N(proda), N(proda) }),
+                                 eosio_assert_message_exception, eosio_assert_message_is("attribute hasn`t been set for account") );
+        BOOST_TEST( "000000000000f03f" == get_account_attribute( N(proda), N(prodb), N(floating))["data"].as_string() );
+
+        unset_attrs(N(prodb), N(floating), { N(proda), N(prodc) });
+        BOOST_TEST(get_account_attribute( N(proda), N(prodb), N(floating)).is_null());
+        BOOST_TEST(get_account_attribute( N(prodc), N(prodb), N(floating)).is_null());
+        BOOST_TEST(!get_account_attribute( N(prodb), N(prodb), N(floating)).is_null());
+        attr_info = get_attribute_info(N(floating));
+        BOOST_TEST( 3 == attr_info["next_id"].as_uint64() );
+        BOOST_TEST( 1 == attr_info["count"].as_uint64() );
+    } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( attribute_directory_test, attribute_tester ) {
+    try {
+        create_accounts({N(rem.attr), N(proda), N(prodb), N(prodc)});
+        set_code_abi(N(rem.attr),
+                     contracts::rem_attr_wasm(),
+                     contracts::rem_attr_abi().data());
+
+        create_attr(N(floating), 3, 1); // type: Double,   privacy type: PublicPointer
+        create_attr(N(largeint), 2, 2); // type: LargeInt, privacy type: PublicConfirmedPointer
+
+        // the directory is disabled by default
+        set_attr(N(prodb), N(proda), N(floating), "000000000000e03f");
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_directory(N(proda)).size() );
+        unset_attr(N(prodb), N(proda), N(floating));
+
+        BOOST_REQUIRE_EXCEPTION( set_directory(N(nonexistent), true), eosio_assert_message_exception,
+                                 eosio_assert_message_is( "attribute does not exist" ) );
+        set_directory(N(floating), true);
+        set_directory(N(largeint), true);
+
+        set_attr(N(prodb), N(proda), N(floating), "000000000000e03f");
+        set_attr(N(prodc), N(proda), N(floating), "000000000000e03f");
+        set_attrs(N(prodb), N(largeint), { { N(proda), "0100000000000000" }, { N(prodc), "0200000000000000" } });
+        // setting a new value doesn't add an entry
+        set_attr(N(prodb), N(proda), N(floating), "000000000000f03f");
+
+        auto entries = get_attribute_directory(N(proda));
+        BOOST_REQUIRE_EQUAL( 3, entries.size() );
+        BOOST_TEST( "floating" == entries[0]["attribute_name"].as_string() );
+        BOOST_TEST( "prodb" == entries[0]["issuer"].as_string() );
+        BOOST_TEST( 0 == entries[0]["attribute_id"].as_uint64() );
+        BOOST_TEST( "prodc" == entries[1]["issuer"].as_string() );
+        BOOST_TEST( 1 == entries[1]["attribute_id"].as_uint64() );
+        BOOST_TEST( "largeint" == entries[2]["attribute_name"].as_string() );
+        BOOST_TEST( entries[2]["pending"].as_bool() );
+        BOOST_REQUIRE_EQUAL( 1, get_attribute_directory(N(prodc)).size() );
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_directory(N(prodb)).size() );
+
+        confirm_attr(N(proda), N(prodb), N(largeint));
+        entries = get_attribute_directory(N(proda));
+        BOOST_TEST( !entries[2]["pending"].as_bool() );
+
+        unset_attr(N(prodc), N(proda), N(floating));
+        unset_attrs(N(prodb), N(largeint), { N(proda), N(prodc) });
+        entries = get_attribute_directory(N(proda));
+        BOOST_REQUIRE_EQUAL( 1, entries.size() );
+        BOOST_TEST( "floating" == entries[0]["attribute_name"].as_string() );
+        BOOST_TEST( "prodb" == entries[0]["issuer"].as_string() );
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_directory(N(prodc)).size() );
+
+        // disabling the directory stops listing new attributes, listed ones are still removed by unset
+        set_directory(N(floating), false);
+        set_attr(N(prodc), N(proda), N(floating), "000000000000e03f");
+        BOOST_REQUIRE_EQUAL( 1, get_attribute_directory(N(proda)).size() );
+        unset_attr(N(prodb), N(proda), N(floating));
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_directory(N(proda)).size() );
+    } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( attribute_directory_backfill_test, attribute_tester ) {
+    try {
+        create_accounts({N(rem.attr), N(proda), N(prodb), N(prodc)});
+        set_code_abi(N(rem.attr),
+                     contracts::rem_attr_wasm(),
+                     contracts::rem_attr_abi().data());
+
+        create_attr(N(largeint), 2, 2); // type: LargeInt, privacy type: PublicConfirmedPointer
+
+        // attributes set before the directory is enabled
+        set_attrs(N(prodb), N(largeint), { { N(proda), "0100000000000000" }, { N(prodc), "0200000000000000" } });
+        set_attr(N(prodc), N(proda), N(largeint), "0300000000000000");
+        confirm_attr(N(proda), N(prodc), N(largeint));
+
+        BOOST_REQUIRE_EXCEPTION( list_attrs(N(largeint), 10), eosio_assert_message_exception,
+                                 eosio_assert_message_is( "directory is not enabled for the attribute" ) );
+        set_directory(N(largeint), true);
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_directory(N(proda)).size() );
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_info(N(largeint))["listed_id"].as_uint64() );
+
+        BOOST_REQUIRE_EXCEPTION( list_attrs(N(largeint), 0), eosio_assert_message_exception,
+                                 eosio_assert_message_is( "max_rows must be positive" ) );
+        BOOST_REQUIRE_EXCEPTION( list_attrs(N(nonexistent), 10), eosio_assert_message_exception,
+                                 eosio_assert_message_is( "attribute does not exist" ) );
+        BOOST_REQUIRE_THROW( base_tester::push_action(N(rem.attr), N(listattrs), N(proda), mvo()
+                                ("attribute_name", N(largeint))
+                                ("max_rows", 10)), missing_auth_exception );
+
+        // an attribute set after the directory is enabled is listed at once
+        set_attr(N(prodc), N(prodb), N(largeint), "0400000000000000");
+        BOOST_REQUIRE_EQUAL( 1, get_attribute_directory(N(prodb)).size() );
+
+        // the listing continues from the last listed attribute
+        list_attrs(N(largeint), 2);
+        BOOST_REQUIRE_EQUAL( 2, get_attribute_info(N(largeint))["listed_id"].as_uint64() );
+        auto entries = get_attribute_directory(N(proda));
+        BOOST_REQUIRE_EQUAL( 1, entries.size() );
+        BOOST_TEST( "prodb" == entries[0]["issuer"].as_string() );
+        BOOST_TEST( 0 == entries[0]["attribute_id"].as_uint64() );
+        BOOST_TEST( entries[0]["pending"].as_bool() );
+        BOOST_REQUIRE_EQUAL( 1, get_attribute_directory(N(prodc)).size() );
+
+        list_attrs(N(largeint), 10);
+        BOOST_REQUIRE_EQUAL( 4, get_attribute_info(N(largeint))["listed_id"].as_uint64() );
+        entries = get_attribute_directory(N(proda));
+        BOOST_REQUIRE_EQUAL( 2, entries.size() );
+        BOOST_TEST( "prodc" == entries[1]["issuer"].as_string() );
+        BOOST_TEST( 2 == entries[1]["attribute_id"].as_uint64() );
+        BOOST_TEST( !entries[1]["pending"].as_bool() );
+        // the attribute listed when it was set is not listed again
+        BOOST_REQUIRE_EQUAL( 1, get_attribute_directory(N(prodb)).size() );
+
+        // enabling the directory again starts the listing over
+        set_directory(N(largeint), false);
+        set_directory(N(largeint), true);
+        BOOST_REQUIRE_EQUAL( 0, get_attribute_info(N(largeint))["listed_id"].as_uint64() );
+    } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( attribute_reader_test, attribute_tester ) {
+    try {
+        create_accounts({N(rem.attr), N(attr.reader), N(proda), N(prodb)});
+        set_code_abi(N(rem.attr),
+                     contracts::rem_attr_wasm(),
+                     contracts::rem_attr_abi().data());
+        set_code_abi(N(attr.reader),
+                     contracts::util::attr_reader_wasm(),
+                     contracts::util::attr_reader_abi().data());
+
+        create_attr(N(name),       5, 1); // type: UTFString,    privacy type: PublicPointer
+        create_attr(N(binary),     9, 1); // type: Binary,       privacy type: PublicPointer
+        create_attr(N(crosschain), 4, 1); // type: ChainAccount, privacy type: PublicPointer
+        create_attr(N(largeint),   2, 2); // type: LargeInt,     privacy type: PublicConfirmedPointer
+
+        // the length byte isn't part of the value
+        set_attr(N(prodb), N(proda), N(name), "06426c61697a65");
+        read_attr(N(readstring), N(prodb), N(proda), N(name), fc::variant("Blaize"));
+        set_attr(N(prodb), N(proda), N(binary), "03010203");
+        read_attr(N(readbinary), N(prodb), N(proda), N(binary), fc::variant("010203"));
+        set_attr(N(prodb), N(prodb), N(binary), "00");
+        read_attr(N(readbinary), N(prodb), N(prodb), N(binary), fc::variant(""));
+
+        const std::string chain_account = "00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff0011223344556677";
+        set_attr(N(prodb), N(proda), N(crosschain), chain_account);
+        read_attr(N(readaccount), N(prodb), N(proda), N(crosschain), fc::variant(chain_account));
+
+        // not set by issuer to receiver
+        read_attr(N(readstring), N(proda), N(proda), N(name), fc::variant());
+        read_attr(N(readaccount), N(prodb), N(prodb), N(crosschain), fc::variant());
+
+        BOOST_REQUIRE_EXCEPTION( read_attr(N(readstring), N(prodb), N(proda), N(binary), fc::variant()),
+                                 eosio_assert_message_exception, eosio_assert_message_is( "attribute type mismatch" ) );
+        BOOST_REQUIRE_EXCEPTION( read_attr(N(readlargeint), N(prodb), N(proda), N(name), fc::variant()),
+                                 eosio_assert_message_exception, eosio_assert_message_is( "attribute type mismatch" ) );
+
+        // a pending value is not found until the receiver confirms it
+        set_attr(N(prodb), N(proda), N(largeint), "0100000000000000");
+        read_attr(N(readlargeint), N(prodb), N(proda), N(largeint), fc::variant());
+        confirm_attr(N(proda), N(prodb), N(largeint));
+        read_attr(N(readlargeint), N(prodb), N(proda), N(largeint), fc::variant(int64_t(1)));
+
+        // the new value stays pending, the confirmed one is still read
+        set_attr(N(prodb), N(proda), N(largeint), "0200000000000000");
+        read_attr(N(readlargeint), N(prodb), N(proda), N(largeint), fc::variant(int64_t(1)));
+    } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -143,6 +143,35 @@ public:
       return r;
    }
 
+   auto addkeys(const name &account, const vector<mvo> &keys, const asset &price_limit, const string &payer_str,
+                const vector<permission_level> &auths) {
+      auto r = base_tester::push_action(N(rem.auth), N(addkeys), auths, mvo()
+         ("account",  account)
+         ("keys", keys )
+         ("price_limit", price_limit )
+         ("payer_str", payer_str )
+      );
+      produce_block();
+      return r;
+   }
+
+   auto rotatekey(const name &account, const crypto::public_key &new_key, const crypto::signature &signed_by_new_key,
+                  const string &extra_pub_key, const crypto::public_key &key, const crypto::signature &signed_by_key,
+                  const asset &price_limit, const string &payer_str, const vector<permission_level> &auths) {
+      auto r = base_tester::push_action(N(rem.auth), N(rotatekey), auths, mvo()
+         ("account",  account)
+         ("new_pub_key_str", new_key )
+         ("signed_by_new_pub_key", signed_by_new_key )
+         ("extra_pub_key", extra_pub_key )
+         ("pub_key_str", key )
+         ("signed_by_pub_key", signed_by_key )
+         ("price_limit", price_limit )
+         ("payer_str", payer_str )
+      );
+      produce_block();
+      return r;
+   }
+
    auto revokeacc(const name &account, const crypto::public_key &key, const vector<permission_level>& auths) {
       auto r = base_tester::push_action(N(rem.auth), N(revokeacc), auths, mvo()
          ("account",  account)
@@ -174,8 +203,30 @@ public:
       return r;
    }
 
-   auto cleanupkeys(const vector<permission_level>& auths) {
-      auto r = base_tester::push_action(N(rem.auth), N(cleanupkeys), auths, mvo());
+   auto migratekeys(uint64_t max_rows, const vector<permission_level>& auths) {
+      auto r = base_tester::push_action(N(rem.auth), N(migratekeys), auths, mvo()
+         ("max_rows", max_rows)
+      );
+      produce_block();
+      return r;
+   }
+
+   // sha256 of the key data without the key type
+   static sha256 get_pub_key_hash(const crypto::public_key &key) {
+      const vector<char> packed_key = fc::raw::pack(key);
+      return sha256::hash(packed_key.data() + 1, packed_key.size() - 1);
+   }
+
+   auto cleanupkeys(uint64_t max_rows, const vector<permission_level>& auths) {
+      auto r = base_tester::push_action(N(rem.auth), N(cleanupkeys), auths, mvo()
+         ("max_rows", max_rows)
+      );
+      produce_block();
+      return r;
+   }
+
+   auto settlefees(const vector<permission_level>& auths) {
+      auto r = base_tester::push_action(N(rem.auth), N(settlefees), auths, mvo());
       produce_block();
       return r;
    }
@@ -236,6 +287,14 @@ public:
       return r;
    }
 
+   auto setdiscattr( name attribute_name, const vector<permission_level>& auths ) {
+      auto r = base_tester::push_action(N(rem.auth), N(setdiscattr), auths, mvo()
+         ("attribute_name", attribute_name)
+      );
+      produce_block();
+      return r;
+   }
+
    auto test_key( sha256 digest, crypto::signature sign) {
       auto r = base_tester::push_action(N(rem.auth), N(getkey), N(rem), mvo()
          ("digest", digest)
@@ -275,14 +334,80 @@ public:
    };
 
    variant get_authkeys_tbl() {
-      return get_singtable(N(rem.auth), N(rem.auth), N(authkeys), "authkeys");
+      return get_singtable(N(rem.auth), N(rem.auth), N(appkeys), "authkeys");
    }
 
    variant get_authkeys_tbl( const name& account ) {
-      vector<char> data = get_row_by_account( N(rem.auth), N(rem.auth), N(authkeys), account );
+      vector<char> data = get_row_by_account( N(rem.auth), N(rem.auth), N(appkeys), account );
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "authkeys", data, abi_serializer::create_yield_function( abi_serializer_max_time ) );
    }
 
+   // write a key to the former authkeys table, as the rem.auth version without the appkeys table did
+   void add_legacy_authkey(uint64_t key, const name &owner, const crypto::public_key &pub_key,
+                           const time_point &not_valid_before, const time_point &not_valid_after) {
+      const bytes data = abi_ser.variant_to_binary("legacy_authkeys", mvo()
+         ("key", key)
+         ("owner", owner)
+         ("pub_key", pub_key)
+         ("extra_pub_key", "")
+         ("not_valid_before", block_timestamp_type(not_valid_before))
+         ("not_valid_after", block_timestamp_type(not_valid_after))
+         ("revoked_at", 0), abi_serializer::create_yield_function( abi_serializer_max_time ));
+
+      vector<controller*> nodes = { control.get() };
+#ifndef NON_VALIDATING_TEST
+      nodes.push_back(validating_node.get());
+#endif
+      for (auto node : nodes) {
+         auto &db = node->mutable_db();
+         auto &resource_limits = node->get_mutable_resource_limits_manager();
+         auto get_table = [&](const name &table) -> const table_id_object& {
+            const auto *t_id = db.find<table_id_object, by_code_scope_table>(
+               boost::make_tuple(N(rem.auth), N(rem.auth), table));
+            if (t_id) {
+               return *t_id;
+            }
+            resource_limits.add_pending_ram_usage(N(rem.auth), config::billable_size_v<table_id_object>);
+            return db.create<table_id_object>([&](auto &t) {
+               t.code  = N(rem.auth);
+               t.scope = N(rem.auth);
+               t.table = table;
+               t.payer = N(rem.auth);
+            });
+         };
+
+         const auto &t_id = get_table(N(authkeys));
+         db.create<key_value_object>([&](auto &o) {
+            o.t_id        = t_id.id;
+            o.primary_key = key;
+            o.payer       = N(rem.auth);
+            o.value.assign(data.data(), data.size());
+         });
+         db.modify(t_id, [](auto &t) { ++t.count; });
+
+         // only the owner index (the second one) of the former table is read by the contract
+         const auto &owner_t_id = get_table(name((N(authkeys).to_uint64_t() & 0xFFFFFFFFFFFFFFF0ULL) | 1));
+         db.create<index64_object>([&](auto &o) {
+            o.t_id          = owner_t_id.id;
+            o.primary_key   = key;
+            o.payer         = N(rem.auth);
+            o.secondary_key = owner.to_uint64_t();
+         });
+         db.modify(owner_t_id, [](auto &t) { ++t.count; });
+
+         resource_limits.add_pending_ram_usage(N(rem.auth), config::billable_size_v<key_value_object> + data.size() +
+                                                            config::billable_size_v<index64_object>);
+      }
+   }
+
+   bool has_legacy_authkey(uint64_t key) {
+      return !get_row_by_account(N(rem.auth), N(rem.auth), N(authkeys), name(key)).empty();
+   }
+
+   variant get_fee_ledger() {
+      return get_singtable(N(rem.auth), N(rem.auth), N(feeledger), "fee_ledger");
+   }
+
    variant get_singtable(const name& contract, const name& scope, const name &table, const string &type) {
       vector<char> data;
       const auto &db = control->db();
@@ -532,6 +657,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_test, rem_auth_tester ) {
       auto auth_contract_balance_before = get_balance(N(rem.auth));
 
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      settlefees(auths_level);
 
       // account balance after addkeyacc should be a account_balance_before - 1 AUTH (to current market price)
       auto account_balance_after = get_balance(account);
@@ -549,6 +675,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_test, rem_auth_tester ) {
       BOOST_REQUIRE_EQUAL(data["not_valid_after"].as_string(), string(ct + days(360)));
       BOOST_REQUIRE_EQUAL(data["extra_pub_key"].as_string(), extra_pub_key);
       BOOST_REQUIRE_EQUAL(data["revoked_at"].as_string(), "0"); // if not revoked == 0
+      BOOST_REQUIRE_EQUAL(data["pub_key_hash"].as_string(), get_pub_key_hash(key_pub).str());
       BOOST_REQUIRE_EQUAL(account_balance_before - storage_fee, account_balance_after);
       BOOST_REQUIRE_EQUAL(auth_contract_balance_before, auth_contract_balance_after);
       BOOST_REQUIRE_EQUAL(auth_stats["supply"].as_string(), "0.0000 AUTH");
@@ -610,6 +737,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_with_discount_test, rem_auth_teste
       set_attr(N(rem.auth), account, N(discount), "d7a3703d0ad7eb3f"); // value = 0.87
 
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      settlefees(auths_level);
 
       // account balance after addkeyacc should be a account_balance_before - 1 AUTH (to current market price)
       auto account_balance_after = get_balance(account);
@@ -660,6 +788,49 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_with_discount_test, rem_auth_teste
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_with_pending_discount_test, rem_auth_tester ) {
+   try {
+      name account = N(proda);
+      vector<permission_level> auths_level = { permission_level{account, config::active_name} };
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      crypto::private_key key_priv = crypto::private_key::generate();
+      crypto::public_key key_pub   = key_priv.get_public_key();
+      const auto price_limit       = core_from_string("500.0000");
+      string extra_pub_key         = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                     "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      double discount              = 0.87;
+      string payer_str;
+
+      sha256 digest = sha256::hash(join( { account.to_string(), key_pub.to_string(), extra_pub_key, payer_str } ));
+      auto signed_by_key = key_priv.sign(digest);
+
+      // tokens to pay for torewards action
+      transfer(config::system_account_name, account, core_from_string("900.0000"), "initial transfer");
+      asset storage_fee = get_auth_purchase_fee(asset{1'0000, AUTH_SYMBOL});
+
+      // attribute name, data_type::Double, privacy_type::PrivateConfirmedPointer
+      create_attr(N(discount), 3, 4);
+      set_attr(N(rem.auth), account, N(discount), "d7a3703d0ad7eb3f"); // value = 0.87
+
+      // the discount is not applied until the account confirms it
+      auto account_balance_before = get_balance(account);
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      BOOST_REQUIRE_EQUAL(account_balance_before - storage_fee, get_balance(account));
+
+      base_tester::push_action(N(rem.auth), N(confirm), account, mvo()
+         ("owner", account)
+         ("issuer", N(rem.auth))
+         ("attribute_name", N(discount))
+      );
+      produce_block();
+
+      account_balance_before = get_balance(account);
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      BOOST_REQUIRE_EQUAL(account_balance_before.get_amount() - storage_fee.get_amount() * discount, get_balance(account).get_amount());
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_with_another_payer_test, rem_auth_tester ) {
    try {
       name account = N(proda);
@@ -685,6 +856,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_rem_with_another_payer_test, rem_auth_
       auto auth_contract_balance_before = get_balance(N(rem.auth));
 
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      settlefees(auths_level);
 
       // account balance after addkeyacc should be a account_balance_before - 1 AUTH (to current market price)
       auto payer_balance_after = get_balance(payer);
@@ -839,6 +1011,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_auth_test, rem_auth_tester ) {
       asset storage_fee = get_auth_purchase_fee(asset{1'0000, AUTH_SYMBOL});
 
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      settlefees(auths_level);
 
       auto account_auth_balance_after = get_balance_auth(account);
       auto auth_contract_balance_after = get_balance(N(rem.auth));
@@ -879,6 +1052,7 @@ BOOST_FIXTURE_TEST_CASE( addkeyacc_pay_by_auth_test, rem_auth_tester ) {
       auth_supply_after = asset::from_string(auth_stats_after["supply"].as_string());
 
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      settlefees(auths_level);
       auth_contract_balance_after = get_balance(N(rem.auth));
 
       int64_t reward_amount = 1'0000 * auth_contract_balance_before.get_amount() / double(auth_supply_after.get_amount());
@@ -1619,6 +1793,53 @@ BOOST_FIXTURE_TEST_CASE( revokedapp_and_sign_by_another_key_test, rem_auth_teste
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( revoke_key_shared_by_accounts_test, rem_auth_tester ) {
+   try {
+      name account         = N(proda);
+      name another_account = N(prodb);
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      updateauth(another_account, N(rem.auth));
+      crypto::private_key key_priv = crypto::private_key::generate();
+      crypto::public_key key_pub   = key_priv.get_public_key();
+      const auto price_limit       = core_from_string("400.0000");
+      string extra_pub_key         = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                     "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      string payer_str;
+
+      auto signed_by_key = key_priv.sign(sha256::hash(join( { account.to_string(), key_pub.to_string(), extra_pub_key, payer_str } )));
+      auto another_signed_by_key = key_priv.sign(sha256::hash(join( { another_account.to_string(), key_pub.to_string(),
+                                                                      extra_pub_key, payer_str } )));
+
+      // tokens to pay for torewards action
+      transfer(config::system_account_name, account, core_from_string("1000.0000"), "initial transfer");
+      transfer(config::system_account_name, another_account, core_from_string("1000.0000"), "initial transfer");
+
+      // the same key is linked to both accounts
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, { permission_level{account, config::active_name} });
+      addkeyacc(another_account, key_pub, another_signed_by_key, extra_pub_key, price_limit, payer_str,
+                { permission_level{another_account, config::active_name} });
+
+      revokeacc(account, key_pub, { permission_level{account, config::active_name} });
+      BOOST_REQUIRE_NE(get_authkeys_tbl(name(0))["revoked_at"].as_uint64(), 0);
+
+      // account has no active app keys, the key of another account is not affected
+      BOOST_REQUIRE_THROW(
+         revokeacc(account, key_pub, { permission_level{account, config::active_name} }), eosio_assert_message_exception
+      );
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(1))["revoked_at"].as_uint64(), 0);
+
+      // the re-added key is found behind the revoked one
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, { permission_level{account, config::active_name} });
+      revokeacc(account, key_pub, { permission_level{account, config::active_name} });
+      BOOST_REQUIRE_NE(get_authkeys_tbl(name(2))["revoked_at"].as_uint64(), 0);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(1))["revoked_at"].as_uint64(), 0);
+
+      revokeacc(another_account, key_pub, { permission_level{another_account, config::active_name} });
+      BOOST_REQUIRE_NE(get_authkeys_tbl(name(1))["revoked_at"].as_uint64(), 0);
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE( revoke_require_app_auth_test, rem_auth_tester ) {
    try {
       name account  = N(proda);
@@ -1693,6 +1914,122 @@ BOOST_FIXTURE_TEST_CASE( revoke_require_app_auth_test, rem_auth_tester ) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( addkeys_test, rem_auth_tester ) {
+   try {
+      name account = N(proda);
+      vector<permission_level> auths_level = { permission_level{account, config::active_name} };
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      const auto price_limit = core_from_string("500.0000");
+      string payer_str;
+
+      vector<crypto::private_key> keys_priv;
+      vector<string> payload = { account.to_string() };
+      for (size_t i = 0; i < 3; ++i) {
+         keys_priv.push_back(crypto::private_key::generate());
+         payload.push_back(keys_priv.back().get_public_key().to_string());
+         payload.push_back("extra key " + std::to_string(i));
+      }
+      payload.push_back(payer_str);
+      sha256 digest = sha256::hash(join(std::move(payload)));
+
+      vector<mvo> keys;
+      for (size_t i = 0; i < keys_priv.size(); ++i) {
+         keys.push_back(mvo()
+            ("pub_key_str", keys_priv[i].get_public_key())
+            ("signed_by_pub_key", keys_priv[i].sign(digest))
+            ("extra_pub_key", "extra key " + std::to_string(i)));
+      }
+
+      transfer(config::system_account_name, account, core_from_string("1000.0000"), "initial transfer");
+      auto account_balance_before = get_balance(account);
+
+      BOOST_REQUIRE_EXCEPTION(addkeys(account, {}, price_limit, payer_str, auths_level),
+                              eosio_assert_message_exception, eosio_assert_message_is("empty keys list"));
+      BOOST_REQUIRE_EXCEPTION(addkeys(account, vector<mvo>(17, keys[0]), price_limit, payer_str, auths_level),
+                              eosio_assert_message_exception,
+                              eosio_assert_message_is("too many keys, at most 16 keys can be added at once"));
+      // the signatures are over the payload of all the keys
+      BOOST_REQUIRE_THROW(addkeys(account, { keys[0], keys[1] }, price_limit, payer_str, auths_level), crypto_api_exception);
+      // Missing authority of proda
+      BOOST_REQUIRE_THROW(addkeys(account, keys, price_limit, payer_str, { permission_level{N(prodb), config::active_name} }),
+                          missing_auth_exception);
+
+      addkeys(account, keys, price_limit, payer_str, auths_level);
+
+      asset storage_fee = get_auth_purchase_fee(asset{1'0000, AUTH_SYMBOL});
+      auto ct = control->head_block_time();
+      for (size_t i = 0; i < keys_priv.size(); ++i) {
+         auto data = get_authkeys_tbl(name(i));
+         BOOST_REQUIRE_EQUAL(data["owner"].as_string(), account.to_string());
+         BOOST_REQUIRE_EQUAL(data["pub_key"].as_string(), keys_priv[i].get_public_key().to_string());
+         BOOST_REQUIRE_EQUAL(data["extra_pub_key"].as_string(), "extra key " + std::to_string(i));
+         BOOST_REQUIRE_EQUAL(data["not_valid_after"].as_string(), string(ct + days(360)));
+         BOOST_REQUIRE_EQUAL(data["revoked_at"].as_string(), "0"); // if not revoked == 0
+      }
+      BOOST_REQUIRE_EQUAL(account_balance_before.get_amount() - 3 * storage_fee.get_amount(), get_balance(account).get_amount());
+      BOOST_REQUIRE_EQUAL(get_fee_ledger()["auth_purchased"].as_string(), "3.0000 AUTH");
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( rotatekey_test, rem_auth_tester ) {
+   try {
+      name account = N(proda);
+      vector<permission_level> auths_level = { permission_level{N(prodb), config::active_name} }; // prodb as a executor
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      crypto::private_key new_key_priv = crypto::private_key::generate();
+      crypto::private_key key_priv     = crypto::private_key::generate();
+      crypto::public_key new_key_pub   = new_key_priv.get_public_key();
+      crypto::public_key key_pub       = key_priv.get_public_key();
+      const auto price_limit           = core_from_string("500.0000");
+      string extra_pub_key             = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                         "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      string payer_str;
+
+      sha256 digest_addkeyacc = sha256::hash(join( { account.to_string(), key_pub.to_string(), extra_pub_key, payer_str } ));
+      sha256 digest_addkeyapp = sha256::hash(join({ account.to_string(), new_key_pub.to_string(), extra_pub_key,
+                                                    key_pub.to_string(), payer_str }) );
+      sha256 digest_rotatekey = sha256::hash(join({ "rotatekey", account.to_string(), new_key_pub.to_string(), extra_pub_key,
+                                                    key_pub.to_string(), payer_str }) );
+
+      auto signed_by_key = key_priv.sign(digest_addkeyacc);
+
+      transfer(config::system_account_name, account, core_from_string("1000.0000"), "initial transfer");
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str,
+                { permission_level{account, config::active_name} });
+      auto account_balance_before = get_balance(account);
+
+      // an addkeyapp payload can't be used to rotate the key
+      BOOST_REQUIRE_EXCEPTION(
+         rotatekey(account, new_key_pub, new_key_priv.sign(digest_addkeyapp), extra_pub_key,
+                   key_pub, key_priv.sign(digest_addkeyapp), price_limit, payer_str, auths_level),
+         eosio_assert_message_exception, eosio_assert_message_is("expected key different than recovered new application key"));
+
+      rotatekey(account, new_key_pub, new_key_priv.sign(digest_rotatekey), extra_pub_key,
+                key_pub, key_priv.sign(digest_rotatekey), price_limit, payer_str, auths_level);
+
+      asset storage_fee = get_auth_purchase_fee(asset{1'0000, AUTH_SYMBOL});
+      auto ct = control->head_block_time();
+      auto revoked_key = get_authkeys_tbl(name(0));
+      auto data = get_authkeys_tbl();
+      BOOST_REQUIRE_EQUAL(revoked_key["pub_key"].as_string(), key_pub.to_string());
+      BOOST_REQUIRE_EQUAL(revoked_key["revoked_at"].as_string(), std::to_string(ct.sec_since_epoch()));
+      BOOST_REQUIRE_EQUAL(data["key"].as_int64(), 1);
+      BOOST_REQUIRE_EQUAL(data["owner"].as_string(), account.to_string());
+      BOOST_REQUIRE_EQUAL(data["pub_key"].as_string(), new_key_pub.to_string());
+      BOOST_REQUIRE_EQUAL(data["not_valid_before"].as_string(), string(ct));
+      BOOST_REQUIRE_EQUAL(data["revoked_at"].as_string(), "0"); // if not revoked == 0
+      BOOST_REQUIRE_EQUAL(account_balance_before - storage_fee, get_balance(account));
+
+      // the rotated key is not active anymore
+      BOOST_REQUIRE_EXCEPTION(
+         rotatekey(account, new_key_pub, new_key_priv.sign(digest_rotatekey), extra_pub_key,
+                   key_pub, key_priv.sign(digest_rotatekey), price_limit, payer_str, auths_level),
+         eosio_assert_message_exception, eosio_assert_message_is("account has no active application keys"));
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE( buyauth_test, rem_auth_tester ) {
    try {
       name account = N(prodb);
@@ -1789,6 +2126,82 @@ BOOST_FIXTURE_TEST_CASE( buyauth_with_discount_test, rem_auth_tester ) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( buyauth_with_configured_discount_attr_test, rem_auth_tester ) {
+   try {
+      name account = N(prodb);
+      vector<permission_level> auths_level = { permission_level{account, config::active_name} };
+      transfer(config::system_account_name, account, core_from_string("5000.0000"), "initial transfer");
+      updateauth(N(prodb), N(rem.auth));
+      auto storage_fee = get_auth_purchase_fee(asset{1'0000, AUTH_SYMBOL});
+
+      create_attr(N(kycdiscount), 3, 3);
+      set_attr(N(rem.auth), account, N(kycdiscount), "000000000000e03f"); // value = 0.5
+
+      // the attribute is not the discount attribute
+      auto account_balance_before = get_balance(account);
+      buyauth(account, auth_from_string("1.0000"), 1, auths_level);
+      BOOST_REQUIRE_EQUAL(account_balance_before - storage_fee, get_balance(account));
+
+      // missing authority of rem.auth
+      BOOST_REQUIRE_THROW(setdiscattr(N(kycdiscount), auths_level), missing_auth_exception);
+      setdiscattr(N(kycdiscount), { permission_level{N(rem.auth), config::active_name} });
+
+      account_balance_before = get_balance(account);
+      buyauth(account, auth_from_string("1.0000"), 1, auths_level);
+      BOOST_REQUIRE_EQUAL(account_balance_before.get_amount() - storage_fee.get_amount() * 0.5, get_balance(account).get_amount());
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( settlefees_test, rem_auth_tester ) {
+   try {
+      name account = N(proda);
+      vector<permission_level> auths_level = { permission_level{account, config::active_name} };
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      crypto::private_key key_priv = crypto::private_key::generate();
+      crypto::public_key key_pub   = key_priv.get_public_key();
+      string extra_pub_key         = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                     "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      string payer_str;
+
+      sha256 digest = sha256::hash(join( { account.to_string(), key_pub.to_string(), extra_pub_key, payer_str } ));
+      auto signed_by_key = key_priv.sign(digest);
+
+      transfer(config::system_account_name, account, core_from_string("2500.0000"), "initial transfer");
+      buyauth(account, auth_from_string("1.0000"), 1, auths_level); // buy 1 AUTH credit
+
+      BOOST_REQUIRE_EXCEPTION(settlefees(auths_level),
+                              eosio_assert_message_exception, eosio_assert_message_is("no key storage fees to settle"));
+
+      // one key is paid in AUTH and one in REM, the fees are only collected by the contract
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, auth_from_string("1.0000"), payer_str, auths_level);
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, core_from_string("500.0000"), payer_str, auths_level);
+
+      auto ledger = get_fee_ledger();
+      BOOST_REQUIRE_EQUAL(ledger["auth_to_retire"].as_string(), "1.0000 AUTH");
+      BOOST_REQUIRE_EQUAL(ledger["auth_purchased"].as_string(), "1.0000 AUTH");
+      BOOST_REQUIRE_EQUAL(get_stats(AUTH_SYMBOL)["supply"].as_string(), "1.0000 AUTH");
+      BOOST_REQUIRE_EQUAL(get_balance_auth(N(rem.auth)).get_amount(), 1'0000);
+
+      // both credits are settled at the REM backing of the supply that includes the credits paid in REM
+      auto auth_contract_balance_before = get_balance(N(rem.auth));
+      settlefees(auths_level);
+      auto auth_contract_balance_after = get_balance(N(rem.auth));
+
+      int64_t reward_amount = auth_contract_balance_before.get_amount() / double(2'0000) * 2'0000;
+
+      BOOST_REQUIRE_EQUAL(auth_contract_balance_before.get_amount() - reward_amount, auth_contract_balance_after.get_amount());
+      BOOST_REQUIRE_EQUAL(get_stats(AUTH_SYMBOL)["supply"].as_string(), "0.0000 AUTH");
+      BOOST_REQUIRE_EQUAL(get_balance_auth(N(rem.auth)).get_amount(), 0);
+
+      ledger = get_fee_ledger();
+      BOOST_REQUIRE_EQUAL(ledger["auth_to_retire"].as_string(), "0.0000 AUTH");
+      BOOST_REQUIRE_EQUAL(ledger["auth_purchased"].as_string(), "0.0000 AUTH");
+      BOOST_REQUIRE_EXCEPTION(settlefees(auths_level),
+                              eosio_assert_message_exception, eosio_assert_message_is("no key storage fees to settle"));
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE( keys_cleanup_test, rem_auth_tester ) {
    try {
       name account = N(proda);
@@ -1813,7 +2226,7 @@ BOOST_FIXTURE_TEST_CASE( keys_cleanup_test, rem_auth_tester ) {
       }
 
       produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(360+181)); // key_lifetime + expiration_time
-      cleanupkeys(auths_level);
+      cleanupkeys(10, auths_level);
 
       auto data = get_authkeys_tbl();
 
@@ -1823,10 +2236,129 @@ BOOST_FIXTURE_TEST_CASE( keys_cleanup_test, rem_auth_tester ) {
       produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(360+181)); // key_lifetime + expiration_time
       addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
 
-      cleanupkeys(auths_level);
+      cleanupkeys(10, auths_level);
       data = get_authkeys_tbl();
       BOOST_REQUIRE_EQUAL(data["key"].as_int64(), 1);
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( keys_cleanup_in_expiry_order_test, rem_auth_tester ) {
+   try {
+      name account = N(proda);
+      vector<permission_level> auths_level = { permission_level{account, config::active_name} };
+      // set account permission rem@code to the rem.auth (allow to execute the action on behalf of the account to rem.auth)
+      updateauth(account, N(rem.auth));
+      crypto::private_key key_priv = crypto::private_key::generate();
+      crypto::public_key key_pub   = key_priv.get_public_key();
+      const auto price_limit       = core_from_string("500.0000");
+      string extra_pub_key         = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                     "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      string payer_str;
+
+      crypto::private_key revoke_key_priv = crypto::private_key::generate();
+      crypto::public_key revoke_key_pub   = revoke_key_priv.get_public_key();
+
+      sha256 digest = sha256::hash(join( { account.to_string(), key_pub.to_string(), extra_pub_key, payer_str } ));
+      auto signed_by_key = key_priv.sign(digest);
+      digest = sha256::hash(join( { account.to_string(), revoke_key_pub.to_string(), extra_pub_key, payer_str } ));
+      auto signed_by_revoke_key = revoke_key_priv.sign(digest);
+
+      // tokens to pay for torewards action
+      transfer(config::system_account_name, account, core_from_string("10000.0000"), "initial transfer");
+
+      BOOST_REQUIRE_EXCEPTION(cleanupkeys(0, auths_level),
+                              eosio_assert_message_exception, eosio_assert_message_is("max_rows must be positive"));
+
+      // the first key stays active, the keys added later are revoked
+      addkeyacc(account, key_pub, signed_by_key, extra_pub_key, price_limit, payer_str, auths_level);
+      for (size_t i = 1; i < 4; ++i) {
+         addkeyacc(account, revoke_key_pub, signed_by_revoke_key, extra_pub_key, price_limit, payer_str, auths_level);
+      }
+      for (size_t i = 1; i < 4; ++i) {
+         revokeacc(account, revoke_key_pub, auths_level);
+         BOOST_REQUIRE_NE(get_authkeys_tbl(name(i))["revoked_at"].as_uint64(), 0);
+      }
+
+      // revoked keys are deleted when the cleanup time has passed after the revocation
+      produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(181));
+      cleanupkeys(2, auths_level);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(1)).is_null(), true);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(2)).is_null(), true);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(3)).is_null(), false);
+
+      // cleanup is not blocked by the active key with the lowest id
+      cleanupkeys(10, { permission_level{N(prodb), config::active_name} });
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(3)).is_null(), true);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(0))["revoked_at"].as_uint64(), 0);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( migratekeys_test, rem_auth_tester ) {
+   try {
+      // missing authority of rem.auth
+      BOOST_REQUIRE_THROW(migratekeys(10, { permission_level{N(proda), config::active_name} }), missing_auth_exception);
+      BOOST_REQUIRE_EXCEPTION(migratekeys(0, { permission_level{N(rem.auth), config::active_name} }),
+                              eosio_assert_message_exception, eosio_assert_message_is("max_rows must be positive"));
+
+      // nothing to migrate
+      migratekeys(10, { permission_level{N(rem.auth), config::active_name} });
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl().is_null(), true);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( migratekeys_legacy_rows_test, rem_auth_tester ) {
+   try {
+      const time_point ct = control->head_block_time();
+      vector<crypto::private_key> legacy_privs;
+      for (size_t i = 0; i < 4; ++i) {
+         legacy_privs.push_back(crypto::private_key::generate());
+      }
+      // key 2 expired longer than the cleanup time ago, ids are sparse as after the former cleanup
+      add_legacy_authkey(0, N(proda), legacy_privs[0].get_public_key(), ct - days(1), ct + days(300));
+      add_legacy_authkey(1, N(prodb), legacy_privs[1].get_public_key(), ct - days(1), ct + days(300));
+      add_legacy_authkey(2, N(prodc), legacy_privs[2].get_public_key(), ct - days(600), ct - days(200));
+      add_legacy_authkey(5, N(prodd), legacy_privs[3].get_public_key(), ct - days(1), ct + days(300));
+      produce_block();
+
+      // a legacy key is moved to the appkeys table on its first use
+      revokeacc(N(proda), legacy_privs[0].get_public_key(), { permission_level{N(proda), config::active_name} });
+      BOOST_REQUIRE_EQUAL(has_legacy_authkey(0), false);
+      auto data = get_authkeys_tbl(name(0));
+      BOOST_REQUIRE_EQUAL(data["owner"].as_string(), "proda");
+      BOOST_REQUIRE_EQUAL(data["pub_key"].as_string(), legacy_privs[0].get_public_key().to_string());
+      BOOST_REQUIRE_NE(data["revoked_at"].as_uint64(), 0);
+
+      // the legacy key signs addkeyapp, the id of the new key is above the ids of the keys not migrated yet
+      name account = N(prodb);
+      updateauth(account, N(rem.auth));
+      transfer(config::system_account_name, account, core_from_string("1000.0000"), "initial transfer");
+      crypto::private_key new_key_priv = crypto::private_key::generate();
+      crypto::public_key new_key_pub   = new_key_priv.get_public_key();
+      crypto::public_key key_pub       = legacy_privs[1].get_public_key();
+      const auto price_limit           = core_from_string("500.0000");
+      string extra_pub_key             = "MFwwDQYJKoZIhvcNAQEBBQADSwAwSAJBAIZDXel8Nh0xnGOo39XE3Jqdi6iQpxRs\n"
+                                         "/r82O1HnpuJFd/jyM3iWInPZvmOnPCP3/Nx4fRNj1y0U9QFnlfefNeECAwEAAQ==";
+      string payer_str;
+
+      sha256 digest = sha256::hash(join({ account.to_string(), new_key_pub.to_string(), extra_pub_key,
+                                          key_pub.to_string(), payer_str }) );
+      addkeyapp(account, new_key_pub, new_key_priv.sign(digest), extra_pub_key, key_pub, legacy_privs[1].sign(digest),
+                price_limit, payer_str, { permission_level{N(proda), config::active_name} });
+
+      BOOST_REQUIRE_EQUAL(has_legacy_authkey(1), false);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(1))["pub_key"].as_string(), key_pub.to_string());
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(6))["pub_key"].as_string(), new_key_pub.to_string());
+
+      // the expired key is dropped, the other one is moved with its id
+      migratekeys(10, { permission_level{N(rem.auth), config::active_name} });
+      BOOST_REQUIRE_EQUAL(has_legacy_authkey(2), false);
+      BOOST_REQUIRE_EQUAL(has_legacy_authkey(5), false);
+      BOOST_REQUIRE_EQUAL(get_authkeys_tbl(name(2)).is_null(), true);
+      data = get_authkeys_tbl(name(5));
+      BOOST_REQUIRE_EQUAL(data["owner"].as_string(), "prodd");
+      BOOST_REQUIRE_EQUAL(data["pub_key"].as_string(), legacy_privs[3].get_public_key().to_string());
+      BOOST_REQUIRE_EQUAL(data["not_valid_after"].as_string(), string(ct + days(300)));
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#include <fc/crypto/base58.hpp>
+#include <fc/crypto/private_key.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <rem.utils/base58.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+   using eosio::base58::decode_status;
+
+   // byte-wise decoder used by rem.swap and rem.auth before the limb based one, kept as a reference
+   template <size_t size>
+   decode_status legacy_base58_to_binary(std::string_view s, std::array<uint8_t, size> &result) {
+      const char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+      std::array<int8_t, 256> base58_map;
+      base58_map.fill(-1);
+      for (unsigned i = 0; i < sizeof(base58_chars) - 1; ++i)
+         base58_map[static_cast<uint8_t>(base58_chars[i])] = i;
+
+      result.fill(0);
+      for (auto &src_digit : s) {
+         int carry = base58_map[static_cast<uint8_t>(src_digit)];
+         if (carry < 0)
+            return decode_status::invalid_digit;
+         for (auto it = result.rbegin(); it != result.rend(); ++it) {
+            int x = *it * 58 + carry;
+            *it = x;
+            carry = x >> 8;
+         }
+         if (carry)
+            return decode_status::out_of_range;
+      }
+      return decode_status::ok;
+   }
+
+   std::string random_base58(size_t length) {
+      std::string s(length, '1');
+      for (auto &c : s)
+         c = eosio::base58::alphabet[std::rand() % 58];
+      return s;
+   }
+
+   std::vector<std::string> generate_pubkeys(size_t count) {
+      std::vector<std::string> keys;
+      keys.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+         keys.push_back(fc::crypto::private_key::generate().get_public_key().to_string().substr(3));
+      }
+      return keys;
+   }
+
+   template <size_t size>
+   void require_equivalent(std::string_view s) {
+      std::array<uint8_t, size> expected{};
+      std::array<uint8_t, size> actual{};
+      const auto expected_status = legacy_base58_to_binary(s, expected);
+      const auto actual_status = eosio::base58::decode(s, actual);
+
+      BOOST_REQUIRE_MESSAGE(expected_status == actual_status, "status mismatch for `" << s << "`");
+      if (expected_status == decode_status::ok) {
+         BOOST_REQUIRE_MESSAGE(expected == actual, "value mismatch for `" << s << "`");
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(rem_base58_tests)
+
+BOOST_AUTO_TEST_CASE(decode_map_test) {
+   for (size_t i = 0; i < 256; ++i) {
+      const char *pos = std::find(std::begin(eosio::base58::alphabet), std::end(eosio::base58::alphabet) - 1, char(i));
+      const int expected = pos == std::end(eosio::base58::alphabet) - 1 ? -1 : pos - eosio::base58::alphabet;
+      BOOST_REQUIRE_EQUAL(expected, eosio::base58::decode_map[i]);
+   }
+   static_assert(eosio::base58::decode_map['1'] == 0);
+   static_assert(eosio::base58::decode_map['z'] == 57);
+   static_assert(eosio::base58::decode_map['0'] == -1);
+}
+
+BOOST_AUTO_TEST_CASE(decode_pubkeys_test) {
+   for (const auto &key : generate_pubkeys(500)) {
+      require_equivalent<37>(key);
+
+      std::array<uint8_t, 37> decoded;
+      BOOST_REQUIRE(eosio::base58::decode(key, decoded) == decode_status::ok);
+      const std::vector<char> fc_decoded = fc::from_base58(key);
+      BOOST_REQUIRE_EQUAL(fc_decoded.size(), decoded.size());
+      BOOST_REQUIRE(std::equal(decoded.begin(), decoded.end(), fc_decoded.begin(),
+                               [](uint8_t a, char b) { return a == static_cast<uint8_t>(b); }));
+   }
+}
+
+BOOST_AUTO_TEST_CASE(decode_edge_cases_test) {
+   const std::vector<std::string> inputs = {
+      "", "1", "11111", "111111", "z", "zzzzz", "zzzzzz", "2", "5Q", "5R", "LUv", "LUw", "1LUv", "11LUw",
+      "0", "O", "I", "l", "+", "1111O", "zzzzzzzzzzzzzzzz0", std::string(1, '\0'), std::string("\xff\x80", 2)
+   };
+   for (const auto &s : inputs) {
+      require_equivalent<1>(s);
+      require_equivalent<2>(s);
+      require_equivalent<3>(s);
+      require_equivalent<4>(s);
+      require_equivalent<37>(s);
+   }
+
+   std::array<uint8_t, 2> value;
+   BOOST_REQUIRE(eosio::base58::decode("LUv", value) == decode_status::ok);
+   BOOST_REQUIRE_EQUAL(0xff, value[0]);
+   BOOST_REQUIRE_EQUAL(0xff, value[1]);
+   BOOST_REQUIRE(eosio::base58::decode("LUw", value) == decode_status::out_of_range);
+   // overflow is reported first when it happens before the invalid digit
+   BOOST_REQUIRE(eosio::base58::decode("LUw0", value) == decode_status::out_of_range);
+   BOOST_REQUIRE(eosio::base58::decode("LU0w", value) == decode_status::invalid_digit);
+}
+
+BOOST_AUTO_TEST_CASE(decode_random_strings_test) {
+   for (size_t i = 0; i < 2000; ++i) {
+      std::string s = random_base58(std::rand() % 60);
+      if (!s.empty() && std::rand() % 4 == 0) {
+         s[std::rand() % s.size()] = "0OIl+/ "[std::rand() % 7];
+      }
+      require_equivalent<4>(s);
+      require_equivalent<21>(s);
+      require_equivalent<37>(s);
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// benchmarks only report their results, they are skipped by a plain unit_test run and labeled "benchmark" in ctest,
+// run them with "ctest -L benchmark" or "unit_test --run_test=rem_base58_benchmarks"
+BOOST_AUTO_TEST_SUITE(rem_base58_benchmarks, * boost::unit_test::disabled())
+
+BOOST_AUTO_TEST_CASE(decode_benchmark) {
+   const auto keys = generate_pubkeys(2000);
+   const size_t rounds = 20;
+   using clock = std::chrono::steady_clock;
+
+   std::array<uint8_t, 37> result;
+   uint64_t sink = 0;
+
+   const auto legacy_start = clock::now();
+   for (size_t r = 0; r < rounds; ++r) {
+      for (const auto &key : keys) {
+         legacy_base58_to_binary(key, result);
+         sink += result[36];
+      }
+   }
+   const auto legacy_time = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - legacy_start);
+
+   const auto limb_start = clock::now();
+   for (size_t r = 0; r < rounds; ++r) {
+      for (const auto &key : keys) {
+         eosio::base58::decode(key, result);
+         sink -= result[36];
+      }
+   }
+   const auto limb_time = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - limb_start);
+
+   BOOST_REQUIRE_EQUAL(0u, sink);
+   BOOST_TEST_MESSAGE("base58 decode of " << keys.size() * rounds << " public keys: legacy "
+                      << legacy_time.count() << " us, limb " << limb_time.count() << " us");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#include <fc/crypto/hex.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <rem.utils/eth_address.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+   using eosio::eth::address_status;
+
+   // loop based Keccak-f[1600] used before the unrolled one, kept as a reference
+   void reference_permute(std::array<uint64_t, 25> &s) {
+      const uint32_t rotations[24] = { 1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+                                       27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44 };
+      const uint32_t pi_lanes[24] = { 10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+                                      15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1 };
+      for (uint32_t round = 0; round < 24; ++round) {
+         uint64_t c[5];
+         for (uint32_t x = 0; x < 5; ++x)
+            c[x] = s[x] ^ s[x + 5] ^ s[x + 10] ^ s[x + 15] ^ s[x + 20];
+         for (uint32_t x = 0; x < 5; ++x) {
+            const uint64_t d = c[(x + 4) % 5] ^ eosio::keccak::detail::rotl(c[(x + 1) % 5], 1);
+            for (uint32_t y = 0; y < 25; y += 5)
+               s[y + x] ^= d;
+         }
+         uint64_t t = s[1];
+         for (uint32_t i = 0; i < 24; ++i) {
+            const uint64_t lane = s[pi_lanes[i]];
+            s[pi_lanes[i]] = eosio::keccak::detail::rotl(t, rotations[i]);
+            t = lane;
+         }
+         for (uint32_t y = 0; y < 25; y += 5) {
+            const uint64_t row[5] = { s[y], s[y + 1], s[y + 2], s[y + 3], s[y + 4] };
+            for (uint32_t x = 0; x < 5; ++x)
+               s[y + x] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
+         }
+         s[0] ^= eosio::keccak::detail::round_constants[round];
+      }
+   }
+
+   std::array<uint8_t, 32> reference_keccak_256(const std::string &data) {
+      const size_t rate = eosio::keccak::hash_256_rate;
+      std::vector<uint8_t> padded(data.begin(), data.end());
+      padded.resize((data.size() / rate + 1) * rate, 0);
+      padded[data.size()] ^= 0x01;
+      padded.back() ^= 0x80;
+
+      std::array<uint64_t, 25> s{};
+      for (size_t block = 0; block < padded.size(); block += rate) {
+         for (size_t i = 0; i < rate; ++i)
+            s[i / 8] ^= uint64_t(padded[block + i]) << (8 * (i % 8));
+         reference_permute(s);
+      }
+      std::array<uint8_t, 32> result;
+      for (size_t i = 0; i < result.size(); ++i)
+         result[i] = static_cast<uint8_t>(s[i / 8] >> (8 * (i % 8)));
+      return result;
+   }
+
+   std::string to_hex(const std::array<uint8_t, 32> &hash) {
+      return fc::to_hex(reinterpret_cast<const char *>(hash.data()), hash.size());
+   }
+
+   std::string keccak_hex(const std::string &data) {
+      return to_hex(eosio::keccak::hash_256(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+   }
+
+   // checksummed addresses from the EIP-55 specification
+   const std::vector<std::string> eip55_addresses = {
+      "0x52908400098527886E0F7030069857D2E4169EE7", "0x8617E340B3D01FA5F11F306F4090FD50E238070D",
+      "0xde709f2102306220921060314715629080e2fb77", "0x27b1fdb04752bbc536007a920d24acb045561c26",
+      "0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed", "0xfB6916095ca1df60bB79Ce92cE3Ea74c37c5d359",
+      "0xdbF03B407c01E7cD3CBea99509d93f8DDDC8C6FB", "0xD1220A0cf47c7B9Be7A2E6BA89F429762e7b9aDb",
+   };
+
+   // reference EIP-55 check over the hex string of the digest
+   bool reference_is_valid_checksum(const std::string &address) {
+      std::string lower = address.substr(2);
+      for (auto &c : lower)
+         c = std::tolower(c);
+      const std::string hash = to_hex(reference_keccak_256(lower));
+      for (size_t i = 0; i < lower.size(); ++i) {
+         const char expected = std::stoi(std::string(1, hash[i]), nullptr, 16) >= 8 ? std::toupper(lower[i]) : lower[i];
+         if (expected != address[i + 2])
+            return false;
+      }
+      return true;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(rem_keccak_tests)
+
+BOOST_AUTO_TEST_CASE(keccak_known_answers_test) {
+   BOOST_REQUIRE_EQUAL("c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470", keccak_hex(""));
+   BOOST_REQUIRE_EQUAL("4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45", keccak_hex("abc"));
+   BOOST_REQUIRE_EQUAL("4d741b6f1eb29cb2a9b9911c82f56fa8d73b04959d3d9d222895df6c0b28aa15",
+                       keccak_hex("The quick brown fox jumps over the lazy dog"));
+   // longer than one block
+   BOOST_REQUIRE_EQUAL("3a57666b048777f2c953dc4456f45a2588e1cb6f2da760122d530ac2ce607d4a",
+                       keccak_hex(std::string(200, '\xa3')));
+
+   constexpr std::array<uint8_t, 3> abc = { 'a', 'b', 'c' };
+   static_assert(eosio::keccak::hash_256(abc)[0] == 0x4e);
+   BOOST_REQUIRE_EQUAL(keccak_hex("abc"), to_hex(eosio::keccak::hash_256(abc)));
+}
+
+BOOST_AUTO_TEST_CASE(keccak_reference_test) {
+   for (size_t size = 0; size < 3 * eosio::keccak::hash_256_rate; ++size) {
+      std::string data(size, '\0');
+      for (auto &c : data)
+         c = static_cast<char>(std::rand());
+      BOOST_REQUIRE_EQUAL(to_hex(reference_keccak_256(data)), keccak_hex(data));
+   }
+
+   for (size_t i = 0; i < 500; ++i) {
+      std::array<uint8_t, eosio::eth::address_size> block;
+      for (auto &c : block)
+         c = static_cast<uint8_t>(std::rand());
+      BOOST_REQUIRE_EQUAL(to_hex(reference_keccak_256(std::string(block.begin(), block.end()))),
+                          to_hex(eosio::keccak::hash_256(block)));
+   }
+}
+
+BOOST_AUTO_TEST_CASE(eip55_vectors_test) {
+   static_assert(eosio::eth::validate_address("0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed") == address_status::ok);
+
+   for (const auto &address : eip55_addresses) {
+      BOOST_REQUIRE(eosio::eth::validate_address(address) == address_status::ok);
+      BOOST_REQUIRE(eosio::eth::validate_address(address.substr(2)) == address_status::ok);
+      BOOST_REQUIRE(reference_is_valid_checksum(address));
+
+      // flipping the case of any letter breaks the checksum unless the whole address becomes lower case
+      for (size_t i = 2; i < address.size(); ++i) {
+         if (!std::isalpha(address[i]))
+            continue;
+         std::string flipped = address;
+         flipped[i] = std::isupper(flipped[i]) ? std::tolower(flipped[i]) : std::toupper(flipped[i]);
+         const bool is_lower = std::none_of(flipped.begin(), flipped.end(), [](char c) { return std::isupper(c); });
+         const auto expected = is_lower ? address_status::ok : address_status::invalid_checksum;
+         BOOST_REQUIRE(eosio::eth::validate_address(flipped) == expected);
+      }
+   }
+
+   BOOST_REQUIRE(eosio::eth::validate_address("0x5aaeb6053f3e94c9b9a09f33669435e7ef1beaed") == address_status::ok);
+   BOOST_REQUIRE(eosio::eth::validate_address("0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAe") == address_status::invalid_length);
+   BOOST_REQUIRE(eosio::eth::validate_address("") == address_status::invalid_length);
+   BOOST_REQUIRE(eosio::eth::validate_address("0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAeg") == address_status::invalid_symbol);
+   BOOST_REQUIRE(eosio::eth::validate_address("0X5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed") == address_status::invalid_length);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// benchmarks only report their results, they are skipped by a plain unit_test run and labeled "benchmark" in ctest,
+// run them with "ctest -L benchmark" or "unit_test --run_test=rem_keccak_benchmarks"
+BOOST_AUTO_TEST_SUITE(rem_keccak_benchmarks, * boost::unit_test::disabled())
+
+BOOST_AUTO_TEST_CASE(eip55_benchmark) {
+   std::vector<std::string> addresses;
+   for (size_t i = 0; i < 2000; ++i)
+      addresses.push_back(eip55_addresses[i % eip55_addresses.size()]);
+   using clock = std::chrono::steady_clock;
+
+   size_t reference_valid = 0;
+   const auto reference_start = clock::now();
+   for (const auto &address : addresses)
+      reference_valid += reference_is_valid_checksum(address);
+   const auto reference_time = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - reference_start);
+
+   size_t valid = 0;
+   const auto unrolled_start = clock::now();
+   for (const auto &address : addresses)
+      valid += eosio::eth::validate_address(address) == address_status::ok;
+   const auto unrolled_time = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - unrolled_start);
+
+   BOOST_REQUIRE_EQUAL(addresses.size(), reference_valid);
+   BOOST_REQUIRE_EQUAL(addresses.size(), valid);
+   BOOST_TEST_MESSAGE("EIP-55 validation of " << addresses.size() << " addresses: reference "
+                      << reference_time.count() << " us, unrolled " << unrolled_time.count() << " us");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
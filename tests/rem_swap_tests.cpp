@@ -87,6 +87,20 @@ public:
       return r;
    }
 
+   auto transfermany(const name& from, const vector<std::pair<name, asset>>& transfers, const string& memo) {
+      fc::variants transfers_var;
+      for (const auto& [to, quantity] : transfers) {
+         transfers_var.push_back(mvo()("first", to)("second", quantity));
+      }
+      auto r = base_tester::push_action(N(rem.token), N(transfermany), from, mvo()
+         ("from", from)
+         ("transfers", transfers_var)
+         ("memo", memo)
+      );
+      produce_block();
+      return r;
+   }
+
    void create_currency(name contract, name manager, asset maxsupply, const private_key_type *signer = nullptr) {
       auto act = mutable_variant_object()
          ("issuer", manager)
@@ -129,6 +143,51 @@ public:
       return r;
    }
 
+   auto init_swap_batch(const name &producer, const vector<init_data> &swaps) {
+      fc::variants descriptors;
+      for (const auto &swap : swaps) {
+         descriptors.push_back(mvo()
+            ("txid", swap.txid)
+            ("swap_pubkey", swap.swap_pubkey)
+            ("quantity", swap.quantity)
+            ("return_address", swap.return_address)
+            ("return_chain_id", swap.return_chain_id)
+            ("swap_timestamp", swap.swap_timestamp)
+         );
+      }
+      auto r = base_tester::push_action(N(rem.swap), N(initbatch), producer, mvo()
+         ("producer", producer)
+         ("swaps", descriptors)
+      );
+      produce_block();
+      return r;
+   }
+
+   auto approve_swap(const name &producer, const string &swap_id) {
+      auto r = base_tester::push_action(N(rem.swap), N(approve), producer, mvo()
+         ("producer", producer)
+         ("swap_id", swap_id)
+      );
+      produce_block();
+      return r;
+   }
+
+   auto cleanup_swaps(const name &account, const uint64_t &max_rows) {
+      auto r = base_tester::push_action(N(rem.swap), N(cleanup), account, mvo()
+         ("max_rows", max_rows)
+      );
+      produce_block();
+      return r;
+   }
+
+   auto migrate_swaps(const name &account, const uint64_t &max_rows) {
+      auto r = base_tester::push_action(N(rem.swap), N(migrateswaps), account, mvo()
+         ("max_rows", max_rows)
+      );
+      produce_block();
+      return r;
+   }
+
    auto cancel_swap(const name &rampayer, const string &txid, const string &swap_pubkey,
                     const asset &quantity, const string &return_address, const string &return_chain_id,
                     const block_timestamp_type &swap_timestamp) {
@@ -273,6 +332,100 @@ public:
       return data.empty() ? variant() : abi_ser.binary_to_variant(type, data, abi_serializer::create_yield_function( abi_serializer_max_time ));
    }
 
+   // rewrite the swap row in the format used before the quantity and approvals mask extensions were added
+   void set_legacy_swap_row(uint64_t key, const vector<name> &provided_approvals) {
+      vector<chainbase::database*> dbs = { &control->mutable_db() };
+#ifndef NON_VALIDATING_TEST
+      dbs.push_back(&validating_node->mutable_db());
+#endif
+      for (auto db : dbs) {
+         const auto *t_id = db->find<table_id_object, by_code_scope_table>(
+            boost::make_tuple(N(rem.swap), N(rem.swap), N(swaps)));
+         BOOST_REQUIRE(t_id != nullptr);
+         const auto &row = db->get<key_value_object, by_scope_primary>(boost::make_tuple(t_id->id, key));
+
+         vector<char> data(row.value.data(), row.value.data() + row.value.size());
+         mvo swap(abi_ser.binary_to_variant("swap_data", data, abi_serializer::create_yield_function( abi_serializer_max_time )).get_object());
+         swap.erase("quantity");
+         swap.erase("approvals");
+         swap("provided_approvals", provided_approvals);
+
+         const bytes legacy_data = abi_ser.variant_to_binary("swap_data", swap, abi_serializer::create_yield_function( abi_serializer_max_time ));
+         db->modify(row, [&](auto &r) {
+            r.value.assign(legacy_data.data(), legacy_data.size());
+         });
+      }
+   }
+
+   // rewrite the producers schedule and standby list of the system contract global state, as a schedule update would
+   void set_schedule_producers(const vector<name> &schedule, const vector<name> &standby) {
+      const auto &accnt = control->db().get<account_object, by_name>(config::system_account_name);
+      abi_def abi_definition;
+      BOOST_REQUIRE_EQUAL(abi_serializer::to_abi(accnt.abi, abi_definition), true);
+      abi_serializer sys_abi_ser(abi_definition, abi_serializer::create_yield_function( abi_serializer_max_time ));
+      auto to_pairs = [](const vector<name> &producers) {
+         fc::variants pairs;
+         for (const auto &producer : producers) {
+            pairs.push_back(mvo()("first", producer)("second", 0.0));
+         }
+         return pairs;
+      };
+
+      vector<chainbase::database*> dbs = { &control->mutable_db() };
+#ifndef NON_VALIDATING_TEST
+      dbs.push_back(&validating_node->mutable_db());
+#endif
+      for (auto db : dbs) {
+         const auto *t_id = db->find<table_id_object, by_code_scope_table>(
+            boost::make_tuple(config::system_account_name, config::system_account_name, N(global)));
+         BOOST_REQUIRE(t_id != nullptr);
+         const auto &row = db->get<key_value_object, by_scope_primary>(boost::make_tuple(t_id->id, N(global).to_uint64_t()));
+
+         vector<char> data(row.value.data(), row.value.data() + row.value.size());
+         mvo global(sys_abi_ser.binary_to_variant("eosio_global_state", data, abi_serializer::create_yield_function( abi_serializer_max_time )).get_object());
+         global("last_schedule", to_pairs(schedule));
+         global("standby", to_pairs(standby));
+
+         const bytes global_data = sys_abi_ser.variant_to_binary("eosio_global_state", global, abi_serializer::create_yield_function( abi_serializer_max_time ));
+         db->modify(row, [&](auto &r) {
+            r.value.assign(global_data.data(), global_data.size());
+         });
+      }
+   }
+
+   variant get_producers_set(uint64_t version) {
+      const vector<char> data = get_row_by_account(N(rem.swap), N(rem.swap), N(prodsets), name(version));
+      return data.empty() ? variant() : abi_ser.binary_to_variant("producers_set", data, abi_serializer::create_yield_function( abi_serializer_max_time ));
+   }
+
+   // erase the expiration index entry of the swap row, as for the swaps created before the index was introduced
+   void unset_swap_expiry_entry(uint64_t key) {
+      vector<controller*> nodes = { control.get() };
+#ifndef NON_VALIDATING_TEST
+      nodes.push_back(validating_node.get());
+#endif
+      for (auto node : nodes) {
+         auto &db = node->mutable_db();
+         // the expiration index is the second one of the swaps table
+         const auto *t_id = db.find<table_id_object, by_code_scope_table>(
+            boost::make_tuple(N(rem.swap), N(rem.swap), name((N(swaps).to_uint64_t() & 0xFFFFFFFFFFFFFFF0ULL) | 1)));
+         BOOST_REQUIRE(t_id != nullptr);
+         const auto &entry = db.get<index64_object, by_primary>(boost::make_tuple(t_id->id, key));
+
+         node->get_mutable_resource_limits_manager().add_pending_ram_usage(
+            entry.payer, -int64_t(config::billable_size_v<index64_object>));
+         db.modify(*t_id, [](auto &t) { --t.count; });
+         db.remove(entry);
+      }
+   }
+
+   size_t get_table_rows_count(const name& contract, const name &table) {
+      const auto &db = control->db();
+      const auto *t_id = db.find<table_id_object, by_code_scope_table>(
+         boost::make_tuple(contract, contract, table));
+      return t_id ? t_id->count : 0;
+   }
+
    asset get_balance(const account_name &act) {
       return get_currency_balance(N(rem.token), symbol(CORE_SYMBOL), act);
    }
@@ -543,6 +696,399 @@ BOOST_FIXTURE_TEST_CASE(init_swap_test, rem_swap_tester) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE(init_swap_long_payload_test, rem_swap_tester) {
+   try {
+      // the swap id payload is longer than the stack buffer of the payload builder
+      init_data init_swap_data = {
+         .txid = string(2000, 'a'),
+         .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+         .swap_timestamp = time_point_sec(control->head_block_time())
+      };
+      time_point swap_timepoint = init_swap_data.swap_timestamp.to_time_point();
+      string swap_payload = join({ init_swap_data.swap_pubkey.substr(3), init_swap_data.txid, control->get_chain_id(),
+                                  init_swap_data.quantity.to_string(), init_swap_data.return_address,
+                                  init_swap_data.return_chain_id, std::to_string(swap_timepoint.sec_since_epoch()) });
+      string swap_id = sha256::hash(swap_payload);
+
+      init_swap(N(proda), init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+
+      auto data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE_EQUAL(init_swap_data.txid, data["txid"].as_string());
+      BOOST_REQUIRE_EQUAL(swap_id, data["swap_id"].as_string());
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(approve_swap_test, rem_swap_tester) {
+   try {
+      init_data init_swap_data = {
+         .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+         .swap_timestamp = time_point_sec(control->head_block_time())
+      };
+      vector<name> producers(_producer_candidates.begin(), _producer_candidates.end());
+      time_point swap_timepoint = init_swap_data.swap_timestamp.to_time_point();
+      string swap_payload = join({ init_swap_data.swap_pubkey.substr(3), init_swap_data.txid, control->get_chain_id(),
+                                  init_swap_data.quantity.to_string(), init_swap_data.return_address,
+                                  init_swap_data.return_chain_id, std::to_string(swap_timepoint.sec_since_epoch()) });
+      string swap_id = sha256::hash(swap_payload);
+      asset before_init_balance = get_balance(N(rem.swap));
+
+      // swap doesn't exist
+      BOOST_REQUIRE_THROW(approve_swap(producers[0], swap_id), eosio_assert_message_exception);
+
+      init_swap(producers[0], init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+
+      // approval already exists
+      BOOST_REQUIRE_THROW(approve_swap(producers[0], swap_id), eosio_assert_message_exception);
+      // only top25 block producers approval is recorded
+      BOOST_REQUIRE_THROW(approve_swap(N(whale1), swap_id), eosio_assert_message_exception);
+
+      uint32_t majority_prod = (producers.size() * 2 / 3) + 1;
+      for (size_t i = 1; i < majority_prod; ++i) {
+         approve_swap(producers[i], swap_id);
+      }
+
+      auto data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      auto core_stats_after = get_stats(symbol(CORE_SYMBOL));
+      // 1 if a swap status issued
+      BOOST_REQUIRE_EQUAL("1", data["status"].as_string());
+      BOOST_REQUIRE_EQUAL(majority_prod, data["approvals"]["count"].as_uint64());
+      BOOST_REQUIRE_EQUAL(0, data["provided_approvals"].get_array().size());
+      // approvals are stored as a mask over the captured producers set
+      auto producers_set = get_singtable(N(rem.swap), N(prodsets), "producers_set");
+      BOOST_REQUIRE_EQUAL(producers_set["version"].as_uint64(), data["approvals"]["producers_version"].as_uint64());
+      uint64_t expected_mask = 0;
+      const auto set_producers = producers_set["producers"].as<vector<name>>();
+      BOOST_REQUIRE(std::is_sorted(set_producers.begin(), set_producers.end()));
+      for (size_t i = 0; i < majority_prod; ++i) {
+         auto it = std::find(set_producers.begin(), set_producers.end(), producers[i]);
+         BOOST_REQUIRE(it != set_producers.end());
+         expected_mask |= uint64_t(1) << (it - set_producers.begin());
+      }
+      BOOST_REQUIRE_EQUAL(expected_mask, data["approvals"]["mask"].as_uint64());
+      BOOST_REQUIRE_EQUAL(init_swap_data.quantity, data["quantity"].as<asset>());
+      BOOST_REQUIRE_EQUAL(before_init_balance + init_swap_data.quantity, get_balance(N(rem.swap)));
+      BOOST_REQUIRE_EQUAL(core_stats_after["supply"].as_string(), "100000201.0000 " + string(CORE_SYMBOL_NAME));
+
+      // approvals after issue are accepted by init and approve without issuing tokens again
+      approve_swap(producers[majority_prod], swap_id);
+      init_swap(producers[majority_prod + 1], init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+      BOOST_REQUIRE_EQUAL(before_init_balance + init_swap_data.quantity, get_balance(N(rem.swap)));
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(approve_legacy_swap_test, rem_swap_tester) {
+   try {
+      init_data init_swap_data = {
+         .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+         .swap_timestamp = time_point_sec(control->head_block_time())
+      };
+      vector<name> producers(_producer_candidates.begin(), _producer_candidates.end());
+      time_point swap_timepoint = init_swap_data.swap_timestamp.to_time_point();
+      string swap_payload = join({ init_swap_data.swap_pubkey.substr(3), init_swap_data.txid, control->get_chain_id(),
+                                  init_swap_data.quantity.to_string(), init_swap_data.return_address,
+                                  init_swap_data.return_chain_id, std::to_string(swap_timepoint.sec_since_epoch()) });
+      string swap_id = sha256::hash(swap_payload);
+      asset before_init_balance = get_balance(N(rem.swap));
+
+      init_swap(producers[0], init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+      set_legacy_swap_row(0, { producers[0] });
+      produce_block();
+
+      auto data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE(!data.get_object().contains("quantity"));
+      BOOST_REQUIRE_EQUAL(1, data["provided_approvals"].get_array().size());
+
+      // the legacy row has no quantity to issue
+      BOOST_REQUIRE_THROW(approve_swap(producers[1], swap_id), eosio_assert_message_exception);
+
+      // init stores the quantity along with the approvals mask
+      init_swap(producers[1], init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE_EQUAL(init_swap_data.quantity, data["quantity"].as<asset>());
+      BOOST_REQUIRE_EQUAL(2, data["approvals"]["count"].as_uint64());
+      BOOST_REQUIRE_EQUAL(0, data["provided_approvals"].get_array().size());
+
+      uint32_t majority_prod = (producers.size() * 2 / 3) + 1;
+      for (size_t i = 2; i < majority_prod; ++i) {
+         approve_swap(producers[i], swap_id);
+      }
+
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      // 1 if a swap status issued
+      BOOST_REQUIRE_EQUAL("1", data["status"].as_string());
+      BOOST_REQUIRE_EQUAL(before_init_balance + init_swap_data.quantity, get_balance(N(rem.swap)));
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(approve_swap_producers_change_test, rem_swap_tester) {
+   try {
+      init_data init_swap_data = {
+         .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+         .swap_timestamp = time_point_sec(control->head_block_time())
+      };
+      vector<name> producers(_producer_candidates.begin(), _producer_candidates.end());
+      time_point swap_timepoint = init_swap_data.swap_timestamp.to_time_point();
+      string swap_payload = join({ init_swap_data.swap_pubkey.substr(3), init_swap_data.txid, control->get_chain_id(),
+                                  init_swap_data.quantity.to_string(), init_swap_data.return_address,
+                                  init_swap_data.return_chain_id, std::to_string(swap_timepoint.sec_since_epoch()) });
+      string swap_id = sha256::hash(swap_payload);
+
+      auto get_mask = [](const vector<name> &set_producers, const vector<name> &approvers) {
+         uint64_t mask = 0;
+         for (const auto &approver : approvers) {
+            auto it = std::find(set_producers.begin(), set_producers.end(), approver);
+            BOOST_REQUIRE(it != set_producers.end());
+            mask |= uint64_t(1) << (it - set_producers.begin());
+         }
+         return mask;
+      };
+      auto get_sorted = [](vector<name> schedule, const vector<name> &standby) {
+         schedule.insert(schedule.end(), standby.begin(), standby.end());
+         std::sort(schedule.begin(), schedule.end());
+         return schedule;
+      };
+
+      // the schedule is set before each action, a schedule update of the system contract would replace it otherwise
+      set_schedule_producers(producers, {});
+      init_swap(N(proda), init_swap_data.txid, init_swap_data.swap_pubkey, init_swap_data.quantity,
+                init_swap_data.return_address, init_swap_data.return_chain_id, init_swap_data.swap_timestamp);
+      for (const auto &producer : { N(prodb), N(prodc), N(prodd) }) {
+         set_schedule_producers(producers, {});
+         approve_swap(producer, swap_id);
+      }
+
+      auto data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      const uint64_t first_version = data["approvals"]["producers_version"].as_uint64();
+      const auto first_set = get_producers_set(first_version)["producers"].as<vector<name>>();
+      BOOST_REQUIRE(first_set == get_sorted(producers, {}));
+      BOOST_REQUIRE_EQUAL(get_mask(first_set, { N(proda), N(prodb), N(prodc), N(prodd) }), data["approvals"]["mask"].as_uint64());
+      BOOST_REQUIRE_EQUAL(4, data["approvals"]["count"].as_uint64());
+
+      // prodc and prode are removed, whale1 and b1 are added and the schedule is reordered
+      vector<name> schedule = producers;
+      schedule.erase(std::remove_if(schedule.begin(), schedule.end(), [](const name &producer) {
+         return producer == N(prodc) || producer == N(prode);
+      }), schedule.end());
+      schedule.push_back(N(whale1));
+      std::reverse(schedule.begin(), schedule.end());
+      const vector<name> standby = { N(b1) };
+
+      set_schedule_producers(schedule, standby);
+      approve_swap(N(prodf), swap_id);
+
+      // the approvals are remapped to the new set, the approval of the removed prodc is discarded
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      const uint64_t second_version = data["approvals"]["producers_version"].as_uint64();
+      BOOST_REQUIRE_EQUAL(first_version + 1, second_version);
+      const auto second_set = get_producers_set(second_version)["producers"].as<vector<name>>();
+      BOOST_REQUIRE(second_set == get_sorted(schedule, standby));
+      BOOST_REQUIRE_EQUAL(get_mask(second_set, { N(proda), N(prodb), N(prodd), N(prodf) }), data["approvals"]["mask"].as_uint64());
+      BOOST_REQUIRE_EQUAL(4, data["approvals"]["count"].as_uint64());
+      BOOST_REQUIRE(get_producers_set(first_version)["superseded_at"].as<time_point>() != time_point());
+
+      // a removed producer can't approve, a remapped approval can't be repeated
+      set_schedule_producers(schedule, standby);
+      BOOST_REQUIRE_THROW(approve_swap(N(prodc), swap_id), eosio_assert_message_exception);
+      set_schedule_producers(schedule, standby);
+      BOOST_REQUIRE_THROW(approve_swap(N(prodb), swap_id), eosio_assert_message_exception);
+
+      // a reordering alone is not a new version
+      std::reverse(schedule.begin(), schedule.end());
+      set_schedule_producers(schedule, standby);
+      approve_swap(N(whale1), swap_id);
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE_EQUAL(second_version, data["approvals"]["producers_version"].as_uint64());
+      BOOST_REQUIRE_EQUAL(get_mask(second_set, { N(proda), N(prodb), N(prodd), N(prodf), N(whale1) }),
+                          data["approvals"]["mask"].as_uint64());
+      BOOST_REQUIRE_EQUAL(5, data["approvals"]["count"].as_uint64());
+
+      // the sets superseded less than swap lifetime ago are kept
+      schedule.push_back(N(whale2));
+      set_schedule_producers(schedule, standby);
+      approve_swap(N(b1), swap_id);
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      const uint64_t third_version = data["approvals"]["producers_version"].as_uint64();
+      BOOST_REQUIRE_EQUAL(second_version + 1, third_version);
+      const auto third_set = get_producers_set(third_version)["producers"].as<vector<name>>();
+      BOOST_REQUIRE_EQUAL(get_mask(third_set, { N(proda), N(prodb), N(prodd), N(prodf), N(whale1), N(b1) }),
+                          data["approvals"]["mask"].as_uint64());
+      BOOST_REQUIRE_EQUAL(6, data["approvals"]["count"].as_uint64());
+      BOOST_REQUIRE(!get_producers_set(first_version).is_null());
+      BOOST_REQUIRE(!get_producers_set(second_version).is_null());
+
+      // the sets superseded more than swap lifetime ago are pruned with the next new version
+      produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(181));
+      init_data next_swap_data = {
+         .txid = "0c5cb5e1a2b0d8d3a89f1cd41c24ac5e4c59ab1a1b1e6a7b1f9a8dbd9a2c3e4f",
+         .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+         .swap_timestamp = time_point_sec(control->head_block_time())
+      };
+      set_schedule_producers(producers, {});
+      init_swap(N(proda), next_swap_data.txid, next_swap_data.swap_pubkey, next_swap_data.quantity,
+                next_swap_data.return_address, next_swap_data.return_chain_id, next_swap_data.swap_timestamp);
+
+      data = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE_EQUAL(third_version + 1, data["approvals"]["producers_version"].as_uint64());
+      BOOST_REQUIRE(get_producers_set(first_version).is_null());
+      BOOST_REQUIRE(get_producers_set(second_version).is_null());
+      // the set superseded by this action is still referenced by unexpired swaps
+      BOOST_REQUIRE(!get_producers_set(third_version).is_null());
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(init_swap_batch_test, rem_swap_tester) {
+   try {
+      const auto swap_timestamp = time_point_sec(control->head_block_time());
+      init_data first_swap = { .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                               .swap_timestamp = swap_timestamp };
+      init_data second_swap = { .txid = "0c5cb5e1a2b0d8d3a89f1cd41c24ac5e4c59ab1a1b1e6a7b1f9a8dbd9a2c3e4f",
+                                .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                                .swap_timestamp = swap_timestamp };
+      init_data unsupported_chain_swap = { .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                                           .return_chain_id = "bitcoin",
+                                           .swap_timestamp = swap_timestamp };
+      init_data low_quantity_swap = { .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                                      .quantity = core_from_string("25.0000"),
+                                      .swap_timestamp = swap_timestamp };
+      vector<name> producers(_producer_candidates.begin(), _producer_candidates.end());
+      asset before_init_balance = get_balance(N(rem.swap));
+
+      auto trace = init_swap_batch(producers[0], { first_swap, unsupported_chain_swap, low_quantity_swap });
+      auto result_it = std::find_if(trace->action_traces.begin(), trace->action_traces.end(), [](const auto &t) {
+         return t.act.name == N(batchresult);
+      });
+      BOOST_REQUIRE(result_it != trace->action_traces.end());
+      auto results = abi_ser.binary_to_variant("batchresult", result_it->act.data,
+                                               abi_serializer::create_yield_function( abi_serializer_max_time ))["results"].get_array();
+      BOOST_REQUIRE_EQUAL(3, results.size());
+      BOOST_REQUIRE_EQUAL("", results[0]["error"].as_string());
+      BOOST_REQUIRE_EQUAL("not supported chain id", results[1]["error"].as_string());
+      BOOST_REQUIRE_EQUAL("the quantity must be greater than the swap fee", results[2]["error"].as_string());
+
+      // approval already exists, other swaps of the batch are recorded
+      trace = init_swap_batch(producers[0], { first_swap, second_swap });
+      result_it = std::find_if(trace->action_traces.begin(), trace->action_traces.end(), [](const auto &t) {
+         return t.act.name == N(batchresult);
+      });
+      results = abi_ser.binary_to_variant("batchresult", result_it->act.data,
+                                          abi_serializer::create_yield_function( abi_serializer_max_time ))["results"].get_array();
+      BOOST_REQUIRE_EQUAL("approval already exists", results[0]["error"].as_string());
+      BOOST_REQUIRE_EQUAL("", results[1]["error"].as_string());
+
+      uint32_t majority_prod = (producers.size() * 2 / 3) + 1;
+      for (size_t i = 1; i < majority_prod; ++i) {
+         init_swap_batch(producers[i], { first_swap, second_swap });
+      }
+      BOOST_REQUIRE_EQUAL(before_init_balance + first_swap.quantity + second_swap.quantity, get_balance(N(rem.swap)));
+
+      // only top25 block producers approval is recorded
+      BOOST_REQUIRE_THROW(init_swap_batch(N(whale1), { first_swap }), eosio_assert_message_exception);
+      // empty swaps list
+      BOOST_REQUIRE_THROW(init_swap_batch(producers[0], {}), eosio_assert_message_exception);
+      // batch results are reported only by the swap contract
+      BOOST_REQUIRE_THROW(base_tester::push_action(N(rem.swap), N(batchresult), producers[0], mvo()
+                             ("producer", producers[0])
+                             ("results", fc::variants())),
+                          missing_auth_exception);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(cleanup_swaps_test, rem_swap_tester) {
+   try {
+      const auto head_time = time_point_sec(control->head_block_time());
+      // the youngest swap gets the lowest primary key and used to block the cleanup of the older ones
+      init_data young_swap = { .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                               .swap_timestamp = head_time - fc::days(1) };
+      init_data middle_swap = { .txid = "0c5cb5e1a2b0d8d3a89f1cd41c24ac5e4c59ab1a1b1e6a7b1f9a8dbd9a2c3e4f",
+                                .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                                .swap_timestamp = head_time - fc::days(10) };
+      init_data old_swap = { .txid = "5a1f3c0b7e9d2a4c6b8e0f1a3c5e7b9d1f2a4c6e8b0d2f4a6c8e0b2d4f6a8c0e",
+                             .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                             .swap_timestamp = head_time - fc::days(20) };
+
+      for (const auto &swap : { young_swap, middle_swap, old_swap }) {
+         init_swap(swap.rampayer, swap.txid, swap.swap_pubkey, swap.quantity,
+                   swap.return_address, swap.return_chain_id, swap.swap_timestamp);
+      }
+      BOOST_REQUIRE_EQUAL(3, get_table_rows_count(N(rem.swap), N(swaps)));
+
+      // max_rows must be positive
+      BOOST_REQUIRE_THROW(cleanup_swaps(N(prodc), 0), eosio_assert_message_exception);
+      // nothing is expired yet
+      cleanup_swaps(N(prodc), 10);
+      BOOST_REQUIRE_EQUAL(3, get_table_rows_count(N(rem.swap), N(swaps)));
+
+      // the old and the middle swaps are expired, the young one is not
+      produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(175));
+
+      // the earliest expired swap is erased first
+      cleanup_swaps(N(prodc), 1);
+      BOOST_REQUIRE_EQUAL(2, get_table_rows_count(N(rem.swap), N(swaps)));
+      BOOST_REQUIRE_EQUAL(middle_swap.txid, get_singtable(N(rem.swap), N(swaps), "swap_data")["txid"].as_string());
+
+      cleanup_swaps(N(prodc), 10);
+      BOOST_REQUIRE_EQUAL(1, get_table_rows_count(N(rem.swap), N(swaps)));
+      BOOST_REQUIRE_EQUAL(young_swap.txid, get_singtable(N(rem.swap), N(swaps), "swap_data")["txid"].as_string());
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(migrate_swaps_test, rem_swap_tester) {
+   try {
+      const auto head_time = time_point_sec(control->head_block_time());
+      init_data young_swap = { .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                               .swap_timestamp = head_time - fc::days(1) };
+      init_data middle_swap = { .txid = "0c5cb5e1a2b0d8d3a89f1cd41c24ac5e4c59ab1a1b1e6a7b1f9a8dbd9a2c3e4f",
+                                .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                                .swap_timestamp = head_time - fc::days(10) };
+      init_data old_swap = { .txid = "5a1f3c0b7e9d2a4c6b8e0f1a3c5e7b9d1f2a4c6e8b0d2f4a6c8e0b2d4f6a8c0e",
+                             .swap_pubkey = get_pubkey_str(crypto::private_key::generate()),
+                             .swap_timestamp = head_time - fc::days(20) };
+
+      for (const auto &swap : { young_swap, middle_swap, old_swap }) {
+         init_swap(swap.rampayer, swap.txid, swap.swap_pubkey, swap.quantity,
+                   swap.return_address, swap.return_chain_id, swap.swap_timestamp);
+      }
+      // all the swaps are created as before the expiration index was introduced
+      for (uint64_t key = 0; key < 3; ++key) {
+         unset_swap_expiry_entry(key);
+      }
+
+      // the old and the middle swaps are expired, the young one is not
+      produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(175));
+
+      // the swaps without an index entry are not erased by the cleanup
+      cleanup_swaps(N(prodc), 10);
+      BOOST_REQUIRE_EQUAL(3, get_table_rows_count(N(rem.swap), N(swaps)));
+
+      // only the contract account can migrate swaps
+      BOOST_REQUIRE_THROW(migrate_swaps(N(prodc), 10), missing_auth_exception);
+      // max_rows must be positive
+      BOOST_REQUIRE_THROW(migrate_swaps(N(rem.swap), 0), eosio_assert_message_exception);
+
+      // the young swap is reindexed with a new key
+      migrate_swaps(N(rem.swap), 1);
+      BOOST_REQUIRE_EQUAL(3, get_table_rows_count(N(rem.swap), N(swaps)));
+      auto swap_row = get_singtable(N(rem.swap), N(swaps), "swap_data");
+      BOOST_REQUIRE_EQUAL(young_swap.txid, swap_row["txid"].as_string());
+      BOOST_REQUIRE_EQUAL(3, swap_row["key"].as_uint64());
+
+      // the expired swaps are erased, the migration stops at the reindexed swap
+      migrate_swaps(N(rem.swap), 10);
+      BOOST_REQUIRE_EQUAL(1, get_table_rows_count(N(rem.swap), N(swaps)));
+      BOOST_REQUIRE_EQUAL(young_swap.txid, get_singtable(N(rem.swap), N(swaps), "swap_data")["txid"].as_string());
+
+      // once expired, the reindexed swap is erased by the cleanup
+      produce_min_num_of_blocks_to_spend_time_wo_inactive_prod(fc::days(10));
+      cleanup_swaps(N(prodc), 10);
+      BOOST_REQUIRE_EQUAL(0, get_table_rows_count(N(rem.swap), N(swaps)));
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_FIXTURE_TEST_CASE(init_swap_after_cancel_test, rem_swap_tester) {
    try {
       init_data init_swap_data = {
@@ -636,7 +1182,7 @@ BOOST_FIXTURE_TEST_CASE(finish_swap_test, rem_swap_tester) {
       // 2 if swap status finish
       BOOST_REQUIRE_EQUAL("2", data["status"].as_string());
       BOOST_REQUIRE_EQUAL(string(swap_timepoint), data["swap_timestamp"].as_string());
-      BOOST_TEST(majority_prod <= data["provided_approvals"].get_array().size());
+      BOOST_TEST(majority_prod <= data["approvals"]["count"].as_uint64());
       // balance equal : receiver balance += swapped quantity - producers_reward
       BOOST_REQUIRE_EQUAL(receiver_before_balance + init_swap_data.quantity - producers_reward,
                           receiver_after_balance);
@@ -881,7 +1427,7 @@ BOOST_FIXTURE_TEST_CASE(finishnewacc_swap_test, rem_swap_tester) {
       BOOST_REQUIRE_EQUAL(string(swap_timepoint), data["swap_timestamp"].as_string());
       // amount of provided approvals must be a 2/3 + 1 of active producers
       uint32_t majority = (_producer_candidates.size() * 2 / 3) + 1;
-      BOOST_TEST(majority <= data["provided_approvals"].get_array().size());
+      BOOST_TEST(majority <= data["approvals"]["count"].as_uint64());
       // balance equal : receiver balance = swapped quantity + min account stake - producers_reward
       BOOST_REQUIRE_EQUAL(init_swap_data.quantity - producers_reward,
                           receiver_after_balance + core_from_string("100.0000"));
@@ -1112,7 +1658,7 @@ BOOST_FIXTURE_TEST_CASE(cancel_swap_test, rem_swap_tester) {
       BOOST_REQUIRE_EQUAL(remswap_before_init_balance + init_swap_data.quantity, remswap_before_cancel_balance);
       // amount of provided approvals must be a 2/3 + 1 of active producers
       uint32_t majority = (_producer_candidates.size() * 2 / 3) + 1;
-      BOOST_TEST(majority <= data["provided_approvals"].get_array().size());
+      BOOST_TEST(majority <= data["approvals"]["count"].as_uint64());
 
       block_timestamp_type swap_not_expired_timestamp = time_point_sec(control->head_block_time());
       // swap lifetime expired if a swap_timeswamp > 180 days
@@ -1206,7 +1752,11 @@ BOOST_FIXTURE_TEST_CASE(init_return_swap_test, rem_swap_tester) {
       auto remswap_before_transfer_balance = get_balance(N(rem.swap));
       auto sender_before_transfer_balance = get_balance(sender);
 
-      transfer(sender, N(rem.swap), quantity, memo);
+      auto trace = transfer(sender, N(rem.swap), quantity, memo);
+      // the return address is validated by rem.swap itself without an inline action to rem.utils
+      BOOST_REQUIRE(std::none_of(trace->action_traces.begin(), trace->action_traces.end(), [](const auto &t) {
+         return t.receiver == N(rem.utils);
+      }));
 
       auto remswap_after_transfer_balance = get_balance(N(rem.swap));
       auto sender_after_transfer_balance = get_balance(sender);
@@ -1224,6 +1774,9 @@ BOOST_FIXTURE_TEST_CASE(init_return_swap_test, rem_swap_tester) {
       // wrong address
       BOOST_REQUIRE_THROW(transfer(sender, N(rem.swap), quantity, return_chain_id + ' '),
                           eosio_assert_message_exception);
+      // invalid ethereum address checksum
+      BOOST_REQUIRE_THROW(transfer(sender, N(rem.swap), quantity, return_chain_id + " 0x9f21f19180C8692EBaa061fd231cd1B029Ff2326"),
+                          eosio_assert_message_exception);
       // symbol precision mismatch
       BOOST_REQUIRE_THROW(transfer(sender, N(rem.swap), asset::from_string("500.0000 SYS"), memo),
                           eosio_assert_message_exception);
@@ -1233,6 +1786,47 @@ BOOST_FIXTURE_TEST_CASE(init_return_swap_test, rem_swap_tester) {
    } FC_LOG_AND_RETHROW()
 };
 
+BOOST_FIXTURE_TEST_CASE(init_return_btc_swap_test, rem_swap_tester) {
+   try {
+      name sender = N(whale3);
+      string return_chain_id = "btc";
+      asset quantity = core_from_string("500.0000");
+
+      vector<permission_level> auths_level = { permission_level{config::system_account_name, config::active_name},
+                                               permission_level{N(rem.swap), config::active_name}};
+      addchain(N(btc), true, true, 1000000, 5000000, auths_level);
+      transfer(N(rem.swap), sender, core_from_string("1000.0000"), "initial transfer");
+
+      auto sender_before_transfer_balance = get_balance(sender);
+      transfer(sender, N(rem.swap), quantity, return_chain_id + " bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4");
+      BOOST_REQUIRE_EQUAL(sender_before_transfer_balance - quantity, get_balance(sender));
+
+      // bech32 return addresses were not validated before the validation moved to rem.swap
+      BOOST_REQUIRE_EXCEPTION(transfer(sender, N(rem.swap), quantity, return_chain_id + " bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t5"),
+                              eosio_assert_message_exception, eosio_assert_message_is("invalid address checksum"));
+      BOOST_REQUIRE_EXCEPTION(transfer(sender, N(rem.swap), quantity, return_chain_id + " bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3tb"),
+                              eosio_assert_message_exception, eosio_assert_message_is("invalid bech32 address"));
+      BOOST_REQUIRE_EQUAL(sender_before_transfer_balance - quantity, get_balance(sender));
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE(transfermany_to_swap_test, rem_swap_tester) {
+   try {
+      name sender = N(whale3);
+      asset quantity = core_from_string("500.0000");
+      auto remswap_balance = get_balance(N(rem.swap));
+
+      // rem.swap handles only transfer notifications, tokens sent by transfermany would be kept without a swap
+      BOOST_REQUIRE_EXCEPTION(transfermany(sender, { { N(whale2), quantity }, { N(rem.swap), quantity } },
+                                           "ethropsten 0x9f21F19180C8692EBaa061fd231cd1B029Ff2326"),
+                              eosio_assert_message_exception,
+                              eosio_assert_message_is("use transfer with the swap memo to send tokens to the swap contract"));
+      BOOST_REQUIRE_EQUAL(remswap_balance, get_balance(N(rem.swap)));
+
+      transfermany(sender, { { N(whale1), quantity }, { N(whale2), quantity } }, "");
+   } FC_LOG_AND_RETHROW()
+};
+
 BOOST_FIXTURE_TEST_CASE(swapparams_test, rem_swap_tester) {
    try {
       setswapparam(control->get_chain_id(), "0x81b7E08F65Bdf5648606c89998A9CC8164397647", "ethropsten");
@@ -1285,3 +1879,47 @@ BOOST_FIXTURE_TEST_CASE(add_chain_test, rem_swap_tester) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+// benchmarks only report their results, they are skipped by a plain unit_test run and labeled "benchmark" in ctest,
+// run them with "ctest -L benchmark" or "unit_test --run_test=rem_swap_benchmarks"
+BOOST_AUTO_TEST_SUITE(rem_swap_benchmarks, * boost::unit_test::disabled())
+
+BOOST_FIXTURE_TEST_CASE(approve_swap_resources_benchmark, rem_swap_tester) {
+   try {
+      vector<name> producers(_producer_candidates.begin(), _producer_candidates.end());
+      const uint32_t majority_prod = (producers.size() * 2 / 3) + 1;
+      const auto swap_timestamp = time_point_sec(control->head_block_time());
+      const string return_address = "9f21f19180c8692ebaa061fd231cd1b029ff2326";
+      const string return_chain_id = "ethropsten";
+
+      auto confirm_swap = [&](const string &txid, bool by_id) {
+         string swap_pubkey = get_pubkey_str(crypto::private_key::generate());
+         string swap_payload = join({ swap_pubkey.substr(3), txid, control->get_chain_id(),
+                                      core_from_string("201.0000").to_string(), return_address, return_chain_id,
+                                      std::to_string(swap_timestamp.sec_since_epoch()) });
+         string swap_id = sha256::hash(swap_payload);
+
+         uint64_t net_usage = 0;
+         uint64_t cpu_usage = 0;
+         for (size_t i = 0; i < majority_prod; ++i) {
+            auto trace = (by_id && i > 0) ? approve_swap(producers[i], swap_id) :
+                                            init_swap(producers[i], txid, swap_pubkey, core_from_string("201.0000"),
+                                                      return_address, return_chain_id, swap_timestamp);
+            net_usage += trace->net_usage;
+            cpu_usage += trace->receipt->cpu_usage_us;
+         }
+         return std::make_pair(net_usage, cpu_usage);
+      };
+
+      const auto [init_net, init_cpu] = confirm_swap("79b9563d89da12715c2ea086b38a5557a521399c87d40d84b8fa5df0fd478046", false);
+      const auto [approve_net, approve_cpu] = confirm_swap("0c5cb5e1a2b0d8d3a89f1cd41c24ac5e4c59ab1a1b1e6a7b1f9a8dbd9a2c3e4f", true);
+
+      BOOST_TEST_MESSAGE("swap confirmed by " << majority_prod << " init actions: net " << init_net
+                         << " bytes, cpu " << init_cpu << " us");
+      BOOST_TEST_MESSAGE("swap confirmed by init and " << majority_prod - 1 << " approve actions: net " << approve_net
+                         << " bytes, cpu " << approve_cpu << " us");
+      BOOST_TEST(approve_net < init_net);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -112,6 +112,15 @@ public:
       return r;
    }
 
+   auto validate_addresses(const name& user, const name& chain_id, const vector<string>& addresses) {
+      auto r = base_tester::push_action(N(rem.utils), N(validatemany), user, mvo()
+              ("chain_id",  chain_id)
+              ("addresses", addresses )
+      );
+      produce_block();
+      return r;
+   }
+
    auto set_swap_fee(const name& chain_id, const asset& fee) {
       auto r = base_tester::push_action(N(rem.utils), N(setswapfee), N(rem.utils), mvo()
               ("chain_id",  chain_id)
@@ -356,4 +365,59 @@ BOOST_FIXTURE_TEST_CASE( validate_eth_address_all_lower, utils_tester ) {
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( validate_many_eth_addresses_test, utils_tester ) {
+   try {
+      vector<string> valid_addresses = {
+         "0xd18a02cafC6715c2e096636aB3349E4B79FAeCE7", "eB5F897477362945af744EbB244be03FbA0248F6",
+         "0x8617E340B3D01FA5F11F306F4090FD50E238070D", "0x45cb76afdb1e30b7f1eca0c3faf0ea2619c0ea33",
+      };
+      validate_addresses(N(proda), N(eth), valid_addresses);
+      validate_addresses(N(proda), N(ethropsten), valid_addresses);
+
+      // invalid ethereum address checksum
+      valid_addresses.push_back("0x9fB8A18fF402680b47387AE0F4e38229EC64f097");
+      BOOST_REQUIRE_EXCEPTION(validate_addresses(N(proda), N(eth), valid_addresses), eosio_assert_message_exception,
+                              eosio_assert_message_is("invalid ethereum address checksum at position 4"));
+      // empty addresses list
+      BOOST_REQUIRE_THROW(validate_addresses(N(proda), N(eth), {}), eosio_assert_message_exception);
+      // not supported chain id
+      BOOST_REQUIRE_THROW(validate_addresses(N(proda), N(unknown), { "address" }), eosio_assert_message_exception);
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( validate_btc_address_test, utils_tester ) {
+   try {
+      vector<string> valid_addresses = {
+         "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2", "3J98t1WpEZ73CNmQviecrnyiWrnqRhWNLy",
+         "1111111111111111111114oLvT2",
+         "BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4",
+         "bc1pw508d6qejxtdg4y5r3zarvary0c5xw7kw508d6qejxtdg4y5r3zarvary0c5xw7kt5nd6y",
+         "bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0",
+      };
+      validate_addresses(N(proda), N(btc), valid_addresses);
+      for (const auto &address: valid_addresses) {
+         validate_address(N(proda), N(btc), address);
+      }
+      validate_addresses(N(proda), N(btctestnet), {
+         "mipcBbFg9gMiCh81Kj8tqqdgoZub1ZJRfn", "2MzQwSSnBHWHqSAqtTVQ6v47XtaisrJa1Vc",
+         "tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sl5k7",
+      });
+
+      const vector<std::pair<string, string>> invalid_addresses = {
+         { "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN3", "invalid address checksum" },
+         { "11BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN2", "invalid base-58 address" },
+         { "1BvBMSEYstWetqTFn5Au4m4GFg7xJaNVN0", "invalid base-58 address" },
+         { "mipcBbFg9gMiCh81Kj8tqqdgoZub1ZJRfn", "invalid address version" },
+         { "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t5", "invalid address checksum" },
+         { "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kemeawh", "invalid witness program" },
+         { "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kV8F3T4", "invalid bech32 address" },
+         { "tb1qrp33g0q5c5txsp9arysrx4k6zdkfs4nce4xj0gdcccefvpysxf3q0sl5k7", "invalid base-58 address" },
+      };
+      for (const auto &[address, error]: invalid_addresses) {
+         BOOST_REQUIRE_EXCEPTION(validate_address(N(proda), N(btc), address), eosio_assert_message_exception,
+                                 eosio_assert_message_is(error));
+      }
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()